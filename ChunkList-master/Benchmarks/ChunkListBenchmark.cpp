@@ -0,0 +1,357 @@
+// Бенчмарк ChunkList против std::vector, std::deque и std::list.
+// Матрица: размер элемента (4–256 байт) x размер чанка N (8–4096) x длина списка (по умолчанию 1K, 100K, 1M).
+// Каждая операция ограничена бюджетом времени: если он исчерпан, в результат попадает число выполненных
+// операций и "truncated": true. Результат — JSON, его удобно сравнивать между ревизиями.
+//
+// Запуск: chunklist_benchmark [--sizes 1000,100000,100000000] [--budget-ms 200] [--filter vector] [--out result.json]
+#include "Chunk.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace fefu_laboratory_two;
+
+namespace {
+	struct Options {
+		std::vector<std::size_t> sizes{ 1000, 100000, 1000000 };
+		double budget_ms = 200;
+		std::string filter;
+		std::string out;
+	};
+
+	// Живые байты и число выделений по всем контейнерам, чтобы сравнивать расход памяти
+	struct Memory {
+		static inline std::size_t live = 0;
+		static inline std::size_t allocations = 0;
+	};
+
+	template <typename T>
+	class CountingAllocator {
+	public:
+		using value_type = T;
+
+		CountingAllocator() noexcept = default;
+
+		template <class U>
+		CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+		T* allocate(std::size_t n) {
+			Memory::live += n * sizeof(T);
+			++Memory::allocations;
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, std::size_t n) noexcept {
+			Memory::live -= n * sizeof(T);
+			::operator delete(p);
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept {
+		return true;
+	}
+
+	// Элемент заданного размера; сравнение идёт по ключу в первых четырёх байтах
+	template <std::size_t Bytes>
+	struct Blob {
+		std::uint32_t key = 0;
+		unsigned char pad[Bytes - sizeof(std::uint32_t)];
+
+		Blob() = default;
+		explicit Blob(std::uint32_t key) : key(key) {}
+	};
+
+	template <>
+	struct Blob<4> {
+		std::uint32_t key = 0;
+
+		Blob() = default;
+		explicit Blob(std::uint32_t key) : key(key) {}
+	};
+
+	template <std::size_t Bytes>
+	bool operator<(const Blob<Bytes>& lhs, const Blob<Bytes>& rhs) {
+		return lhs.key < rhs.key;
+	}
+
+	template <std::size_t Bytes>
+	bool operator==(const Blob<Bytes>& lhs, const Blob<Bytes>& rhs) {
+		return lhs.key == rhs.key;
+	}
+
+	class Budget {
+	public:
+		explicit Budget(double ms) : limit(ms), start(std::chrono::steady_clock::now()) {}
+
+		// Время проверяется раз в 256 операций, чтобы не мерить сами часы
+		bool expired(std::size_t done) const {
+			return (done & 255) == 0 && done != 0 && elapsed_ms() > limit;
+		}
+
+		double elapsed_ms() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		double limit;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	struct Result {
+		std::string container;
+		std::string operation;
+		std::size_t element_size = 0;
+		int chunk_size = 0;
+		std::size_t size = 0;
+		std::size_t ops = 0;
+		double ns_per_op = 0;
+		std::size_t bytes = 0;
+		bool truncated = false;
+	};
+
+	std::vector<Result> results;
+
+	// Единый интерфейс к контейнерам; ChunkList и std-контейнеры различаются перегрузками
+	template <class C>
+	void push_front(C& c, const typename C::value_type& value) {
+		if constexpr (requires { c.push_front(value); })
+			c.push_front(value);
+		else
+			c.insert(c.begin(), value);
+	}
+
+	template <class C>
+	const typename C::value_type& element_at(C& c, std::size_t index) {
+		if constexpr (requires { c.at(index); })
+			return c.at(index);
+		else
+			return *std::next(c.begin(), index);
+	}
+
+	template <class C>
+	void insert_erase_middle(C& c, std::size_t mid, const typename C::value_type& value) {
+		if constexpr (requires { c.cbegin() + 1; }) {
+			c.insert(c.cbegin() + mid, value);
+			c.erase(c.cbegin() + mid);
+		}
+		else {
+			auto it = c.insert(std::next(c.begin(), mid), value);
+			c.erase(it);
+		}
+	}
+
+	// Контейнеры, которые сортируются на месте; остальные сортируются через копию в std::vector
+	// и попадают в отчёт как sort_via_copy, чтобы их не сравнивали с настоящей сортировкой
+	template <class C>
+	constexpr bool sorts_in_place = requires(C& c) { c.sort(); } || std::random_access_iterator<typename C::iterator>;
+
+	// Возвращает false, если сортировка не уложилась в бюджет
+	template <class C>
+	bool sort_container(C& c, const Budget& budget) {
+		if constexpr (requires { c.sort(); }) {
+			c.sort();
+			return true;
+		}
+		else if constexpr (sorts_in_place<C>) {
+			std::sort(c.begin(), c.end());
+			return true;
+		}
+		else {
+			// У итераторов ChunkList нет разности, поэтому std::sort к ним неприменим: выгружаем, сортируем, загружаем
+			std::vector<typename C::value_type> tmp;
+			tmp.reserve(c.size());
+			for (const auto& elem : c) {
+				tmp.push_back(elem);
+				if (budget.expired(tmp.size()))
+					return false;
+			}
+			std::sort(tmp.begin(), tmp.end());
+			c.assignIt(tmp.begin(), tmp.end());
+			return true;
+		}
+	}
+
+	template <class C>
+	void run(const Options& options, const std::string& name, std::size_t element_size, int chunk_size) {
+		if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+			return;
+
+		using value_type = typename C::value_type;
+		for (std::size_t size : options.sizes) {
+			std::fprintf(stderr, "%s elem=%zu N=%d size=%zu\n", name.c_str(), element_size, chunk_size, size);
+			auto record = [&](const std::string& operation, std::size_t ops, double ms, bool truncated, std::size_t bytes = 0) {
+				Result result{ name, operation, element_size, chunk_size, size, ops, ops == 0 ? 0 : ms * 1e6 / ops, bytes, truncated };
+				results.push_back(result);
+			};
+
+			std::mt19937 random(42);
+			std::size_t live_before = Memory::live;
+			C list;
+			{
+				Budget budget(options.budget_ms * 10);
+				std::size_t i = 0;
+				for (; i < size && !budget.expired(i); ++i)
+					list.push_back(value_type(static_cast<std::uint32_t>(random())));
+				record("push_back", i, budget.elapsed_ms(), i < size);
+				record("memory", list.size(), 0, i < size, Memory::live - live_before);
+			}
+
+			{
+				C front;
+				Budget budget(options.budget_ms);
+				std::size_t i = 0;
+				for (; i < size && !budget.expired(i); ++i)
+					push_front(front, value_type(static_cast<std::uint32_t>(i)));
+				record("push_front", i, budget.elapsed_ms(), i < size);
+			}
+
+			std::size_t count = list.size();
+			if (count == 0)
+				continue;
+
+			{
+				std::uniform_int_distribution<std::size_t> index(0, count - 1);
+				std::uint64_t sum = 0;
+				Budget budget(options.budget_ms);
+				std::size_t i = 0;
+				for (; i < count && !budget.expired(i); ++i)
+					sum += element_at(list, index(random)).key;
+				record("random_at", i, budget.elapsed_ms(), i < count);
+				if (sum == 1)
+					std::fprintf(stderr, " ");
+			}
+
+			{
+				std::uint64_t sum = 0;
+				Budget budget(options.budget_ms);
+				std::size_t i = 0;
+				for (const value_type& elem : list) {
+					sum += elem.key;
+					if (budget.expired(++i))
+						break;
+				}
+				record("iterate", i, budget.elapsed_ms(), i < count);
+				if (sum == 1)
+					std::fprintf(stderr, " ");
+			}
+
+			{
+				std::size_t pairs = std::min<std::size_t>(count, 1000);
+				Budget budget(options.budget_ms);
+				std::size_t i = 0;
+				for (; i < pairs && !budget.expired(i); ++i)
+					insert_erase_middle(list, count / 2, value_type(static_cast<std::uint32_t>(i)));
+				record("insert_erase_middle", i, budget.elapsed_ms(), i < pairs);
+			}
+
+			{
+				Budget budget(options.budget_ms);
+				C copy(list);
+				record("copy", copy.size(), budget.elapsed_ms(), false);
+			}
+
+			{
+				Budget budget(options.budget_ms * 10);
+				bool done = sort_container(list, budget);
+				record(sorts_in_place<C> ? "sort" : "sort_via_copy", done ? count : 0, budget.elapsed_ms(), !done);
+			}
+		}
+	}
+
+	template <std::size_t Bytes, int... Ns>
+	void run_element(const Options& options) {
+		using value_type = Blob<Bytes>;
+		run<std::vector<value_type, CountingAllocator<value_type>>>(options, "std::vector", Bytes, 0);
+		run<std::deque<value_type, CountingAllocator<value_type>>>(options, "std::deque", Bytes, 0);
+		run<std::list<value_type, CountingAllocator<value_type>>>(options, "std::list", Bytes, 0);
+		(run<ChunkList<value_type, Ns, CountingAllocator<value_type>>>(options, "ChunkList", Bytes, Ns), ...);
+	}
+
+	std::string json_escape(const std::string& text) {
+		std::string result;
+		for (char c : text) {
+			if (c == '"' || c == '\\')
+				result += '\\';
+			result += c;
+		}
+		return result;
+	}
+
+	void write_json(std::ostream& out, const Options& options) {
+		out << "{\n  \"budget_ms\": " << options.budget_ms << ",\n  \"results\": [\n";
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const Result& r = results[i];
+			char ns[32];
+			std::snprintf(ns, sizeof(ns), "%.3f", r.ns_per_op);
+			out << "    {\"container\": \"" << json_escape(r.container) << "\", \"operation\": \"" << r.operation
+				<< "\", \"element_size\": " << r.element_size << ", \"chunk_size\": " << r.chunk_size
+				<< ", \"size\": " << r.size << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << ns
+				<< ", \"bytes\": " << r.bytes << ", \"truncated\": " << (r.truncated ? "true" : "false") << "}"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "  ]\n}\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options options;
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			std::string value = i + 1 < argc ? argv[i + 1] : "";
+			if (arg == "--sizes") {
+				options.sizes.clear();
+				std::stringstream list(value);
+				for (std::string item; std::getline(list, item, ',');)
+					options.sizes.push_back(std::stoull(item));
+				++i;
+			}
+			else if (arg == "--budget-ms") {
+				options.budget_ms = std::stod(value);
+				++i;
+			}
+			else if (arg == "--filter") {
+				options.filter = value;
+				++i;
+			}
+			else if (arg == "--out") {
+				options.out = value;
+				++i;
+			}
+			else {
+				std::fprintf(stderr, "usage: %s [--sizes a,b,c] [--budget-ms ms] [--filter name] [--out file]\n", argv[0]);
+				std::exit(2);
+			}
+		}
+		return options;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options = parse(argc, argv);
+
+	run_element<4, 8, 64, 512, 4096>(options);
+	run_element<16, 8, 64, 512, 4096>(options);
+	run_element<64, 8, 64, 512, 4096>(options);
+	run_element<256, 8, 64, 512, 4096>(options);
+
+	if (options.out.empty()) {
+		write_json(std::cout, options);
+	}
+	else {
+		std::ofstream out(options.out);
+		write_json(out, options);
+	}
+	return 0;
+}
@@ -0,0 +1,67 @@
+// Сравнение emplace_back/emplace с push_back/insert для тяжёлых элементов.
+// Сборка: g++ -std=c++20 -O2 -I.. EmplaceBenchmark.cpp -o EmplaceBenchmark
+#include "Chunk.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace fefu_laboratory_two;
+
+namespace {
+	// Запись на 200 байт с нетривиальным конструктором, как в рабочих списках
+	struct Record {
+		int id;
+		char payload[196];
+
+		Record(int id, char tag) : id(id) {
+			std::memset(payload, tag, sizeof(payload));
+		}
+	};
+
+	using RecordList = ChunkList<Record, 64>;
+
+	template <class Fill>
+	double measure(int count, int repeats, Fill fill) {
+		double best = 0;
+		for (int r = 0; r < repeats; r++) {
+			RecordList list;
+			auto start = std::chrono::steady_clock::now();
+			fill(list, count);
+			auto stop = std::chrono::steady_clock::now();
+			double ns = std::chrono::duration<double, std::nano>(stop - start).count() / count;
+			if (r == 0 || ns < best)
+				best = ns;
+		}
+		return best;
+	}
+}
+
+int main() {
+	const int count = 200000;
+	const int middle_count = 20000;
+	const int repeats = 7;
+
+	double push = measure(count, repeats, [](RecordList& list, int n) {
+		for (int i = 0; i < n; i++)
+			list.push_back(Record(i, 'x'));
+	});
+	double emplace = measure(count, repeats, [](RecordList& list, int n) {
+		for (int i = 0; i < n; i++)
+			list.emplace_back(i, 'x');
+	});
+	double insert_front = measure(middle_count, repeats, [](RecordList& list, int n) {
+		for (int i = 0; i < n; i++)
+			list.insert(list.cbegin(), Record(i, 'x'));
+	});
+	double emplace_front = measure(middle_count, repeats, [](RecordList& list, int n) {
+		for (int i = 0; i < n; i++)
+			list.emplace_front(i, 'x');
+	});
+
+	std::printf("%-16s %10s\n", "case", "ns/op");
+	std::printf("%-16s %10.2f\n", "push_back", push);
+	std::printf("%-16s %10.2f\n", "emplace_back", emplace);
+	std::printf("%-16s %10.2f\n", "insert(begin)", insert_front);
+	std::printf("%-16s %10.2f\n", "emplace_front", emplace_front);
+	return 0;
+}
@@ -0,0 +1,317 @@
+// Проверка на регрессии: основные операции ChunkList сравниваются с сохранённой базой (baseline.json).
+// Каждый сценарий прогоняется repeats раз; время сравнивается по медиане с порогом, учитывающим разброс (MAD),
+// а число выделений памяти — точно, поэтому лишнее выделение на push_back ловится детерминированно.
+//
+// Запуск: chunklist_regression --baseline baseline.json [--update] [--allocations-only] [--repeats 15]
+//         [--tolerance 0.10] [--mad-factor 3]
+// Код возврата 1 — найдена регрессия, 2 — ошибка запуска.
+#include "Chunk.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+	// Счётчик глобальных operator new; считаются только выделения внутри замеряемого участка
+	std::size_t allocation_count = 0;
+}
+
+void* operator new(std::size_t size) {
+	++allocation_count;
+	if (void* p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	++allocation_count;
+	std::size_t align = static_cast<std::size_t>(alignment);
+	if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+using namespace fefu_laboratory_two;
+
+namespace {
+	// Сценарий: prepare готовит состояние вне замера, run выполняет ops операций
+	struct Scenario {
+		std::string name;
+		std::size_t ops;
+		std::function<void()> prepare;
+		std::function<void()> run;
+		std::function<void()> finish;
+	};
+
+	struct Measurement {
+		double median_ns = 0;
+		double mad_ns = 0;
+		std::size_t allocations = 0;
+	};
+
+	struct Options {
+		std::string baseline;
+		bool update = false;
+		bool allocations_only = false;
+		int repeats = 15;
+		double tolerance = 0.10;
+		double mad_factor = 3;
+	};
+
+	double median(std::vector<double> values) {
+		std::sort(values.begin(), values.end());
+		std::size_t mid = values.size() / 2;
+		return values.size() % 2 == 1 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+	}
+
+	Measurement measure(const Scenario& scenario, int repeats) {
+		std::vector<double> samples;
+		Measurement result;
+		// Первый прогон прогревает кэши и malloc и в результат не входит
+		for (int i = -1; i < repeats; ++i) {
+			scenario.prepare();
+			std::size_t before = allocation_count;
+			auto start = std::chrono::steady_clock::now();
+			scenario.run();
+			auto stop = std::chrono::steady_clock::now();
+			std::size_t allocations = allocation_count - before;
+			scenario.finish();
+			if (i < 0)
+				continue;
+
+			// Число выделений не должно зависеть от прогона; берём наихудшее
+			result.allocations = std::max(result.allocations, allocations);
+			samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / scenario.ops);
+		}
+
+		result.median_ns = median(samples);
+		for (double& sample : samples)
+			sample = std::abs(sample - result.median_ns);
+		result.mad_ns = median(samples);
+		return result;
+	}
+
+	// Базовые сценарии. Списки живут в статических переменных, чтобы их создание и уничтожение не попадали в замер
+	std::vector<Scenario> scenarios() {
+		using List = ChunkList<int, 64>;
+		static List list;
+		static std::optional<List> copy;
+		static std::vector<int> indices;
+
+		auto fill = [](List& target, int count) {
+			target.clear();
+			target.shrink_to_fit();
+			for (int i = 0; i < count; ++i)
+				target.push_back(i);
+		};
+		auto reset = [] {
+			list.clear();
+			list.shrink_to_fit();
+			copy.reset();
+		};
+
+		std::vector<Scenario> result;
+		result.push_back({ "push_back_within_chunk", 63,
+			[=] { reset(); list.push_back(0); },
+			[] { for (int i = 1; i < 64; ++i) list.push_back(i); },
+			reset });
+		result.push_back({ "push_back_100k", 100000,
+			reset,
+			[] { for (int i = 0; i < 100000; ++i) list.push_back(i); },
+			reset });
+		result.push_back({ "reserve_then_push_back_100k", 100000,
+			reset,
+			[] { list.reserve(100000); for (int i = 0; i < 100000; ++i) list.push_back(i); },
+			reset });
+		result.push_back({ "push_front_10k", 10000,
+			reset,
+			[] { for (int i = 0; i < 10000; ++i) list.push_front(i); },
+			reset });
+		result.push_back({ "random_at_10k", 10000,
+			[=] {
+				fill(list, 10000);
+				indices.clear();
+				unsigned state = 1;
+				for (int i = 0; i < 10000; ++i) {
+					state = state * 1103515245 + 12345;
+					indices.push_back(static_cast<int>(state % 10000));
+				}
+			},
+			[] {
+				long long sum = 0;
+				for (int index : indices)
+					sum += list.at(index);
+				if (sum == -1)
+					std::puts("");
+			},
+			reset });
+		result.push_back({ "iterate_10k", 10000,
+			[=] { fill(list, 10000); },
+			[] {
+				long long sum = 0;
+				for (int value : list)
+					sum += value;
+				if (sum == -1)
+					std::puts("");
+			},
+			reset });
+		result.push_back({ "insert_middle_1k", 1000,
+			[=] { fill(list, 10000); },
+			[] { for (int i = 0; i < 1000; ++i) list.insert(list.cbegin() + 5000, i); },
+			reset });
+		result.push_back({ "erase_middle_1k", 1000,
+			[=] { fill(list, 10000); },
+			[] { for (int i = 0; i < 1000; ++i) list.erase(list.cbegin() + 5000); },
+			reset });
+		result.push_back({ "copy_100k", 100000,
+			[=] { fill(list, 100000); },
+			[] { copy.emplace(list); },
+			reset });
+		return result;
+	}
+
+	// База — JSON с одной записью на строку: "name": {"median_ns": ..., "mad_ns": ..., "allocations": ...}
+	double field(const std::string& line, const std::string& key) {
+		std::size_t pos = line.find("\"" + key + "\":");
+		if (pos == std::string::npos)
+			throw std::invalid_argument("missing " + key + " in: " + line);
+		return std::stod(line.substr(pos + key.size() + 3));
+	}
+
+	std::map<std::string, Measurement> read_baseline(const std::string& path) {
+		std::ifstream in(path);
+		if (!in)
+			throw std::invalid_argument("cannot open baseline " + path);
+
+		std::map<std::string, Measurement> result;
+		for (std::string line; std::getline(in, line);) {
+			std::size_t open = line.find('"');
+			if (open == std::string::npos || line.find("median_ns") == std::string::npos)
+				continue;
+			std::string name = line.substr(open + 1, line.find('"', open + 1) - open - 1);
+			result[name] = Measurement{ field(line, "median_ns"), field(line, "mad_ns"),
+				static_cast<std::size_t>(field(line, "allocations")) };
+		}
+		return result;
+	}
+
+	void write_baseline(const std::string& path, const std::vector<std::pair<std::string, Measurement>>& measured) {
+		std::ofstream out(path);
+		out << "{\n";
+		for (std::size_t i = 0; i < measured.size(); ++i) {
+			char line[256];
+			std::snprintf(line, sizeof(line), "  \"%s\": {\"median_ns\": %.3f, \"mad_ns\": %.3f, \"allocations\": %zu}%s\n",
+				measured[i].first.c_str(), measured[i].second.median_ns, measured[i].second.mad_ns,
+				measured[i].second.allocations, i + 1 < measured.size() ? "," : "");
+			out << line;
+		}
+		out << "}\n";
+	}
+
+	Options parse(int argc, char** argv) {
+		Options options;
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--update")
+				options.update = true;
+			else if (arg == "--allocations-only")
+				options.allocations_only = true;
+			else if (i + 1 < argc && arg == "--baseline")
+				options.baseline = argv[++i];
+			else if (i + 1 < argc && arg == "--repeats")
+				options.repeats = std::max(1, std::atoi(argv[++i]));
+			else if (i + 1 < argc && arg == "--tolerance")
+				options.tolerance = std::atof(argv[++i]);
+			else if (i + 1 < argc && arg == "--mad-factor")
+				options.mad_factor = std::atof(argv[++i]);
+			else
+				throw std::invalid_argument("unknown argument " + arg);
+		}
+		if (options.baseline.empty())
+			throw std::invalid_argument("--baseline is required");
+		return options;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	std::map<std::string, Measurement> baseline;
+	try {
+		options = parse(argc, argv);
+		if (!options.update)
+			baseline = read_baseline(options.baseline);
+	}
+	catch (const std::exception& e) {
+		std::fprintf(stderr, "%s\nusage: %s --baseline file [--update] [--allocations-only] [--repeats n] "
+			"[--tolerance fraction] [--mad-factor k]\n", e.what(), argv[0]);
+		return 2;
+	}
+
+	std::vector<std::pair<std::string, Measurement>> measured;
+	int failures = 0;
+	for (const Scenario& scenario : scenarios()) {
+		Measurement current = measure(scenario, options.allocations_only ? 1 : options.repeats);
+		measured.emplace_back(scenario.name, current);
+		if (options.update) {
+			std::printf("%-28s %10.2f ns/op  mad %8.2f  allocations %zu\n", scenario.name.c_str(),
+				current.median_ns, current.mad_ns, current.allocations);
+			continue;
+		}
+
+		auto it = baseline.find(scenario.name);
+		if (it == baseline.end()) {
+			std::printf("%-28s missing from baseline\n", scenario.name.c_str());
+			++failures;
+			continue;
+		}
+		const Measurement& base = it->second;
+
+		// Выделения сравниваются точно: и рост, и падение означают, что базу пора пересмотреть
+		bool allocations_ok = current.allocations == base.allocations;
+		// Порог по времени: относительный допуск или k * MAD (в масштабе стандартного отклонения), что больше
+		double noise = options.mad_factor * 1.4826 * std::max(current.mad_ns, base.mad_ns);
+		double limit = base.median_ns + std::max(options.tolerance * base.median_ns, noise);
+		bool time_ok = options.allocations_only || current.median_ns <= limit;
+
+		std::printf("%-28s %s allocations %zu (baseline %zu)", scenario.name.c_str(),
+			allocations_ok && time_ok ? "ok  " : "FAIL", current.allocations, base.allocations);
+		if (!options.allocations_only)
+			std::printf("  %.2f ns/op (baseline %.2f, limit %.2f)", current.median_ns, base.median_ns, limit);
+		std::printf("\n");
+		if (!allocations_ok || !time_ok)
+			++failures;
+	}
+
+	if (options.update) {
+		write_baseline(options.baseline, measured);
+		std::printf("baseline written to %s\n", options.baseline.c_str());
+		return 0;
+	}
+	std::printf("%d regression(s)\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+﻿#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+
+namespace fefu_laboratory_two {
+	// Переходы по двусвязной цепочке узлов с полями prev и next и числом элементов count().
+	// На них стоят ChunkList (узлы Chunk) и BlockChain
+
+	// Вставляет связанные узлы head..tail после prev; nullptr — в начало цепочки [first, last]
+	template <typename Node>
+	void chain_link_after(Node*& first, Node*& last, Node* prev, Node* head, Node* tail) noexcept {
+		head->prev = prev;
+		tail->next = prev != nullptr ? prev->next : first;
+		if (tail->next != nullptr)
+			tail->next->prev = tail;
+		else
+			last = tail;
+		if (prev != nullptr)
+			prev->next = head;
+		else
+			first = head;
+	}
+
+	template <typename Node>
+	void chain_link_after(Node*& first, Node*& last, Node* prev, Node* node) noexcept {
+		chain_link_after(first, last, prev, node, node);
+	}
+
+	// Вынимает node из цепочки, сам узел не освобождается
+	template <typename Node>
+	void chain_unlink(Node*& first, Node*& last, Node* node) noexcept {
+		if (node->prev != nullptr)
+			node->prev->next = node->next;
+		else
+			first = node->next;
+		if (node->next != nullptr)
+			node->next->prev = node->prev;
+		else
+			last = node->prev;
+	}
+
+	// Находит узел, в котором лежит элемент pos, и смещение внутри него; hops — число пройденных переходов.
+	// Для pos, равного числу элементов, возвращает последний узел и смещение за его последним элементом.
+	// Узлы бывают разной ёмкости и заполнены не до конца, поэтому поиск идёт по цепочке за O(число узлов)
+	template <typename Node>
+	Node* chain_locate(Node* first, std::size_t pos, int& offset, std::size_t& hops) noexcept {
+		Node* node = first;
+		while (node->next != nullptr && pos >= static_cast<std::size_t>(node->count())) {
+			pos -= node->count();
+			node = node->next;
+			++hops;
+		}
+		offset = static_cast<int>(pos);
+		return node;
+	}
+
+	// Общая основа ColumnarChunkList и PackedChunkList: цепочка блоков на chain_* с учётом числа блоков
+	// и элементов, копирование и перемещение списка. Блок хранит несколько элементов и даёт
+	// конструктор Block(const Allocator&), поля prev и next, count() — число элементов — и copy_from(const Block&),
+	// копирующий содержимое в пустой блок. Пустые блоки в цепочке не остаются
+	template <typename Block, typename Allocator>
+	class BlockChain {
+	public:
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+
+		explicit BlockChain(const Allocator& alloc = Allocator()) : allocator(alloc) {}
+
+		BlockChain(const BlockChain& other)
+			: allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)) {
+			copy_from(other);
+		}
+
+		BlockChain(BlockChain&& other) noexcept : allocator(other.allocator) {
+			steal(other);
+		}
+
+		~BlockChain() {
+			clear();
+		}
+
+		BlockChain& operator=(const BlockChain& other) {
+			if (this == &other)
+				return *this;
+			clear();
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value)
+				allocator = other.allocator;
+			copy_from(other);
+			return *this;
+		}
+
+		BlockChain& operator=(BlockChain&& other) {
+			if (this == &other)
+				return *this;
+			clear();
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+				allocator = other.allocator;
+			// Чужие блоки можно забрать, только если их освободит наш аллокатор
+			if (allocator == other.allocator) {
+				steal(other);
+			}
+			else {
+				copy_from(other);
+				other.clear();
+			}
+			return *this;
+		}
+
+		allocator_type get_allocator() const noexcept {
+			return allocator;
+		}
+
+		size_type size() const noexcept {
+			return list_size;
+		}
+
+		bool empty() const noexcept {
+			return list_size == 0;
+		}
+
+		size_type chunk_count() const noexcept {
+			return block_count;
+		}
+
+		void clear() noexcept {
+			for (Block* block = first_block; block != nullptr;) {
+				Block* next = block->next;
+				destroy_block(block);
+				block = next;
+			}
+			first_block = tail_block = nullptr;
+			block_count = 0;
+			list_size = 0;
+		}
+
+		void swap(BlockChain& other) noexcept {
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+				std::swap(allocator, other.allocator);
+			std::swap(first_block, other.first_block);
+			std::swap(tail_block, other.tail_block);
+			std::swap(block_count, other.block_count);
+			std::swap(list_size, other.list_size);
+		}
+
+	protected:
+		using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+
+		Block* locate(size_type pos, int& offset) const noexcept {
+			std::size_t hops = 0;
+			return chain_locate(first_block, pos, offset, hops);
+		}
+
+		// Новый пустой блок после prev; nullptr — в начало цепочки
+		Block* insert_block_after(Block* prev) {
+			node_allocator alloc(allocator);
+			Block* block = std::allocator_traits<node_allocator>::allocate(alloc, 1);
+			try {
+				std::allocator_traits<node_allocator>::construct(alloc, block, allocator);
+			}
+			catch (...) {
+				std::allocator_traits<node_allocator>::deallocate(alloc, block, 1);
+				throw;
+			}
+
+			chain_link_after(first_block, tail_block, prev, block);
+			++block_count;
+			return block;
+		}
+
+		void unlink_block(Block* block) noexcept {
+			chain_unlink(first_block, tail_block, block);
+			--block_count;
+			destroy_block(block);
+		}
+
+		void destroy_block(Block* block) noexcept {
+			node_allocator alloc(allocator);
+			std::allocator_traits<node_allocator>::destroy(alloc, block);
+			std::allocator_traits<node_allocator>::deallocate(alloc, block, 1);
+		}
+
+		Allocator allocator;
+		Block* first_block = nullptr;
+		Block* tail_block = nullptr;
+		size_type block_count = 0;
+		size_type list_size = 0;
+
+	private:
+		// Копирует блоки other с тем же заполнением; если копирование бросит, список остаётся пустым
+		void copy_from(const BlockChain& other) {
+			try {
+				for (Block* from = other.first_block; from != nullptr; from = from->next) {
+					Block* to = insert_block_after(tail_block);
+					to->copy_from(*from);
+					list_size += to->count();
+				}
+			}
+			catch (...) {
+				clear();
+				throw;
+			}
+		}
+
+		void steal(BlockChain& other) noexcept {
+			first_block = std::exchange(other.first_block, nullptr);
+			tail_block = std::exchange(other.tail_block, nullptr);
+			block_count = std::exchange(other.block_count, 0);
+			list_size = std::exchange(other.list_size, 0);
+		}
+	};
+}
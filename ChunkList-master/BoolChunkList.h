@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include "Chunk.h"
+#include "PackedChunkList.h"
+
+
+namespace fefu_laboratory_two {
+	// Флагов в чанке ChunkList<bool, N>: N, округлённое вверх до степени двойки, но не меньше двух слов
+	template <int N>
+	inline constexpr int packed_bool_chunk_size = std::max(128, static_cast<int>(std::bit_ceil(static_cast<unsigned>(N))));
+
+	// ChunkList<bool> хранит флаги по 64 в слове, как std::vector<bool>: вместо bool& выдаётся PackedReference<1>,
+	// а ChunkListInterface не реализуется. N — число флагов в чанке; встроенного чанка нет, InlineN должен быть 0.
+	// Доступен интерфейс PackedChunkList: at, [], front, back, итераторы, push_back, pop_back, insert(pos, value),
+	// erase(pos), count, find, fill, append, resize, flip, clear, swap, а также push_front и pop_front.
+	// Остального интерфейса ChunkList нет: emplace, вставки и удаления по итератору и диапазоном, reserve,
+	// set_chunk_policy, compact, shrink_to_fit, splice_*, split_at, drop_front, truncate_back, apply_batch,
+	// stats и counters
+	template <int N, typename Alloc, int InlineN>
+	class ChunkList<bool, N, Alloc, InlineN>
+		: public PackedChunkList<1, packed_bool_chunk_size<N>, typename std::allocator_traits<Alloc>::template rebind_alloc<std::uint64_t>> {
+		static_assert(InlineN == 0, "ChunkList<bool> has no inline chunk");
+		using base = PackedChunkList<1, packed_bool_chunk_size<N>, typename std::allocator_traits<Alloc>::template rebind_alloc<std::uint64_t>>;
+	public:
+		using base::base;
+
+		ChunkList() = default;
+
+		void push_front(bool value) {
+			this->insert(0, value);
+		}
+
+		void pop_front() {
+			if (!this->empty())
+				this->erase(0);
+		}
+	};
+}
@@ -6,6 +6,17 @@
 #include <exception>
 #include <compare>
 #include <iostream>
+#include <array>
+#include <new>
+#include <cstring>
+#include <type_traits>
+#include <memory_resource>
+#include <vector>
+#include <optional>
+#include <thread>
+#include "BlockChain.h"
+#include "ChunkProbes.h"
+#include "NumaPolicy.h"
 
 
 namespace fefu_laboratory_two {
@@ -42,10 +53,25 @@ namespace fefu_laboratory_two {
 
 		void deallocate(pointer p, const size_t N) noexcept {
 			static_cast<void>(N);
-			free(p);
+			::operator delete(p);
 		}
 	};
 
+	template <class T, class U>
+	constexpr bool operator==(const Allocator<T>&, const Allocator<U>&) noexcept {
+		return true;
+	}
+
+	// Заголовок блока памяти, из которого reserve() нарезает чанки: за ним лежат заголовки чанков
+	// и их буферы подряд. Блоки связаны в список у зарезервировавшего их списка и освобождаются только целиком.
+	// refs — живые заголовки чанков плюс ссылка этого списка: после splice и split_at чанки блока
+	// могут жить в других списках, и блок освобождает тот, кто отпустит его последним
+	struct ChunkSlab {
+		ChunkSlab* next = nullptr;
+		std::size_t bytes = 0;
+		int refs = 0;
+	};
+
 	template <typename ValueType, typename Allocator = Allocator<ValueType>>
 	class Chunk {
 	public:
@@ -56,16 +82,79 @@ namespace fefu_laboratory_two {
 		int chunk_size = 0;
 		int num_of_elements = 0;
 		Allocator allocator;
+		bool owns_list = true;
+		// Блок reserve(), из которого нарезан чанк
+		ChunkSlab* slab = nullptr;
+
+		Chunk(int N, const Allocator& alloc = Allocator()) : allocator(alloc) {
+			list = std::allocator_traits<Allocator>::allocate(allocator, N);
+			chunk_size = N;
+		}
+
+		// Число элементов для общих переходов по цепочке (chain_locate)
+		int count() const noexcept {
+			return num_of_elements;
+		}
 
-		Chunk(int N) {
-			list = allocator.allocate(N);
+		// Чанк поверх чужого буфера (встроенный чанк ChunkList): буфер не освобождается
+		Chunk(ValueType* storage, int N, const Allocator& alloc = Allocator()) : allocator(alloc) {
+			list = storage;
 			chunk_size = N;
+			owns_list = false;
+		}
+
+		~Chunk() {
+			clear();
+			if (owns_list)
+				std::allocator_traits<Allocator>::deallocate(allocator, list, chunk_size);
+		}
+
+		// Слоты буфера — сырая память: живы только элементы [0, num_of_elements).
+		// Для тривиальных типов конструирование сводится к записи, а уничтожение пропускается
+		template <class... Args>
+		void construct(ValueType* slot, Args&&... args) {
+			std::allocator_traits<Allocator>::construct(allocator, slot, std::forward<Args>(args)...);
+		}
+
+		void destroy(ValueType* first, ValueType* last) noexcept {
+			if constexpr (!std::is_trivially_destructible_v<ValueType>) {
+				for (; first != last; ++first)
+					std::allocator_traits<Allocator>::destroy(allocator, first);
+			}
+		}
+
+		// Переносит живые элементы [first, last) в сырые слоты, начиная с dest; исходные слоты становятся сырыми.
+		// Диапазоны могут перекрываться; перенос на то же место ничего не делает
+		void relocate(ValueType* first, ValueType* last, ValueType* dest) {
+			if (first == dest)
+				return;
+			if constexpr (std::is_trivially_copyable_v<ValueType>) {
+				if (first != last)
+					std::memmove(static_cast<void*>(dest), first, (last - first) * sizeof(ValueType));
+			}
+			else if (dest < first) {
+				for (; first != last; ++first, ++dest) {
+					construct(dest, std::move(*first));
+					destroy(first, first + 1);
+				}
+			}
+			else {
+				for (ValueType* d_last = dest + (last - first); first != last;) {
+					construct(--d_last, std::move(*--last));
+					destroy(last, last + 1);
+				}
+			}
+		}
+
+		void clear() noexcept {
+			destroy(begin(), end());
+			num_of_elements = 0;
 		}
 
 		ValueType* get_data() {
-			ValueType* data = allocator.allocate(chunk_size);
-			for (int i = 0; i < chunk_size; i++)
-				data[i] = list[i];
+			ValueType* data = std::allocator_traits<Allocator>::allocate(allocator, chunk_size);
+			for (int i = 0; i < num_of_elements; i++)
+				construct(data + i, list[i]);
 			return data;
 		}
 
@@ -84,54 +173,144 @@ namespace fefu_laboratory_two {
 			if (new_size == chunk_size)
 				return;
 
-			size_type min_v = (chunk_size > new_size) ? new_size : chunk_size;
-			ValueType* new_list = allocator.allocate(new_size);
-			for (int i = 0; i < min_v; ++i) {
-				new_list[i] = list[i];
-			}
-
-			if (num_of_elements > new_size)
+			if (num_of_elements > new_size) {
+				destroy(list + new_size, end());
 				num_of_elements = new_size;
+			}
 
-			allocator.deallocate(list, chunk_size);
+			ValueType* new_list = std::allocator_traits<Allocator>::allocate(allocator, new_size);
+			relocate(begin(), end(), new_list);
+			std::allocator_traits<Allocator>::deallocate(allocator, list, chunk_size);
 			list = new_list;
 			chunk_size = new_size;
 		}
 
 		void resize(size_type new_size, const ValueType& value) {
-			if (new_size < 0)
-				throw std::invalid_argument("New size cannot be negative");
+			resize(new_size);
+			for (; num_of_elements < new_size; ++num_of_elements)
+				construct(end(), value);
+		}
+	};
 
-			if (new_size == chunk_size)
-				return;
-			
-			ValueType* new_list = allocator.allocate(new_size);
-			if (new_size <= chunk_size) {
-				for (int i = 0; i < new_size; ++i) {
-					new_list[i] = list[i];
-				}
-			}
-			else {
-				for (int i = 0; i < chunk_size; ++i) {
-					new_list[i] = list[i];
-				}
+	// Политика размеров чанков. initial_size — ёмкость новых чанков (0 — взять N из шаблона),
+	// max_size — предел геометрического роста: каждый следующий чанк в конце списка вдвое больше
+	// предыдущего, пока не достигнет max_size (0 — рост отключён). Ёмкости берутся как есть, без округления:
+	// позиция ищется проходом по цепочке, а не сдвигом. Ёмкость не больше max_chunk_capacity, чтобы удвоение не переполняло int
+	inline constexpr int max_chunk_capacity = 1 << 30;
 
-				for (int i = chunk_size; i < new_size; ++i) {
-					new_list[i] = value;
-				}
-			}
+	struct ChunkPolicy {
+		int initial_size = 0;
+		int max_size = 0;
+	};
 
+	// Операция пакета apply_batch. Позиции относятся к списку до применения пакета: вставка с pos кладёт value
+	// перед исходным элементом pos (pos == size() — в конец), удаление убирает исходный элемент pos
+	enum class ChunkListOpKind {
+		Insert,
+		Erase
+	};
 
-			if (num_of_elements > new_size)
-				num_of_elements = new_size;
+	template <typename T>
+	struct ChunkListOp {
+		ChunkListOpKind kind = ChunkListOpKind::Insert;
+		std::size_t pos = 0;
+		// Значение есть только у вставки, поэтому T не обязан конструироваться по умолчанию
+		std::optional<T> value;
+
+		static ChunkListOp insert(std::size_t pos, T value) {
+			return ChunkListOp{ ChunkListOpKind::Insert, pos, std::optional<T>(std::move(value)) };
+		}
 
-			allocator.deallocate(list, chunk_size);
-			list = new_list;
-			chunk_size = new_size;
-			num_of_elements = new_size;
+		static ChunkListOp erase(std::size_t pos) {
+			return ChunkListOp{ ChunkListOpKind::Erase, pos, std::nullopt };
 		}
 	};
 
+	// Снимок устройства списка без обхода элементов. fill_histogram[i] — число чанков с заполненностью
+	// в [i / 10, (i + 1) / 10), полные чанки попадают в последнюю корзину. Недозаполненным считается чанк,
+	// занятый меньше чем наполовину. bytes_allocated, allocations и deallocations учитывают только память,
+	// полученную через аллокатор (заголовки, буферы и блоки reserve), без встроенного чанка.
+	// Где лежит эта память, список не знает: долю huge pages для HugePageAllocator сообщает HugePageArena::stats()
+	struct ChunkListStats {
+		std::size_t size = 0;
+		std::size_t chunk_count = 0;
+		std::size_t capacity = 0;
+		std::size_t spare_capacity = 0;
+		std::size_t bytes_allocated = 0;
+		std::size_t longest_underfilled_run = 0;
+		std::size_t allocations = 0;
+		std::size_t deallocations = 0;
+		std::array<std::size_t, 10> fill_histogram{};
+
+		double fill_factor() const noexcept {
+			return capacity == 0 ? 1.0 : static_cast<double>(size) / capacity;
+		}
+	};
+
+	// Счётчики горячих путей: chunk_hops — переходы по цепочке чанков при поиске позиции,
+	// element_moves — элементы, перенесённые при вставке, удалении и уплотнении, allocations — обращения к аллокатору
+	struct ChunkListCounters {
+		std::size_t chunk_hops = 0;
+		std::size_t element_moves = 0;
+		std::size_t allocations = 0;
+	};
+
+	// Счётчики собираются, только если до подключения Chunk.h определён CHUNKLIST_ENABLE_COUNTERS.
+	// Без него состояние пустое, все вызовы пустые и ChunkList не меняет ни размера, ни кода
+#if defined(CHUNKLIST_ENABLE_COUNTERS)
+	struct ChunkListCounterState {
+		static constexpr bool enabled = true;
+		mutable ChunkListCounters values;
+
+		void hops(std::size_t count) const noexcept { values.chunk_hops += count; }
+		void moves(std::size_t count) const noexcept { values.element_moves += count; }
+		void allocations(std::size_t count) const noexcept { values.allocations += count; }
+		ChunkListCounters snapshot() const noexcept { return values; }
+		void reset() noexcept { values = ChunkListCounters(); }
+	};
+#else
+	struct ChunkListCounterState {
+		static constexpr bool enabled = false;
+
+		void hops(std::size_t) const noexcept {}
+		void moves(std::size_t) const noexcept {}
+		void allocations(std::size_t) const noexcept {}
+		ChunkListCounters snapshot() const noexcept { return ChunkListCounters(); }
+		void reset() noexcept {}
+	};
+#endif
+
+	// Число элементов T, помещающихся в Bytes байт (не меньше одного)
+	template <typename T, std::size_t Bytes>
+	struct ChunkBudget {
+		static constexpr int chunk_size = static_cast<int>(std::max<std::size_t>(Bytes / sizeof(T), 1));
+	};
+
+	// Размер чанка для ChunkList<T> без явного N. По умолчанию чанк занимает около 4 КиБ;
+	// для своего типа достаточно специализации, например
+	// template <> struct ChunkTraits<Record> : ChunkBudget<Record, 64 * 1024> {};
+	template <typename T>
+	struct ChunkTraits : ChunkBudget<T, 4096> {};
+
+	// Первый чанк, хранящийся прямо в объекте ChunkList: до InlineN элементов список живёт без
+	// обращений к аллокатору. При InlineN == 0 структура пустая
+	template <typename T, typename Allocator, int InlineN>
+	struct InlineChunk {
+		alignas(T) unsigned char storage[InlineN * sizeof(T)];
+		Chunk<T, Allocator> chunk;
+		bool in_use = false;
+
+		explicit InlineChunk(const Allocator& alloc) : chunk(reinterpret_cast<T*>(storage), InlineN, alloc) {}
+		InlineChunk(const InlineChunk&) = delete;
+		InlineChunk& operator=(const InlineChunk&) = delete;
+	};
+
+	template <typename T, typename Allocator>
+	struct InlineChunk<T, Allocator, 0> {
+		explicit InlineChunk(const Allocator&) {}
+	};
+
+
 	template<typename ValueType>
 	class ChunkListInterface {
 	public:
@@ -419,12 +598,41 @@ namespace fefu_laboratory_two {
 		};
 	};
 
-	template <typename T, int N, typename Allocator = Allocator<T>>
+	template <typename T, int N = ChunkTraits<T>::chunk_size, typename Allocator = Allocator<T>, int InlineN = 0>
 	class ChunkList : public ChunkListInterface<T> {
+		static_assert(N > 0, "Chunk size must be positive");
+		static_assert(N <= max_chunk_capacity, "Chunk size is too large");
+		static_assert(InlineN >= 0, "Inline chunk size must be non-negative");
 	protected:
+		using slab_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned char>;
+		using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk<T, Allocator>>;
+
+		// Перецепить чанки можно без исключений; встроенный чанк переносится поэлементно
+		static constexpr bool nothrow_steal = InlineN == 0 || std::is_nothrow_move_constructible_v<T>;
+		// Перемещающее присваивание обходится без поэлементного переноса, когда память other можно вернуть нашим аллокатором
+		static constexpr bool nothrow_move_assign = nothrow_steal
+			&& (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+				|| std::allocator_traits<Allocator>::is_always_equal::value);
+
+		Allocator allocator;
+		[[no_unique_address]] InlineChunk<T, Allocator, InlineN> inline_chunk{ allocator };
+		int chunk_count = 0;
 		Chunk<T, Allocator>* first_chunk = nullptr;
+		Chunk<T, Allocator>* tail_chunk = nullptr;
 		int list_size = 0;
 		int chunk_size = N;
+		int max_chunk_size = chunk_size;
+		std::size_t total_capacity = 0;
+		double auto_compact_threshold = 0;
+		double auto_compact_fill = 1;
+		std::size_t capacity_limit = 0;
+		Chunk<T, Allocator>* spare_chunks = nullptr;
+		std::size_t spare_capacity = 0;
+		ChunkSlab* slabs = nullptr;
+		std::size_t allocated_bytes = 0;
+		std::size_t allocation_count = 0;
+		std::size_t deallocation_count = 0;
+		[[no_unique_address]] ChunkListCounterState counter_state;
 	public:
 
 		using value_type = T;
@@ -438,173 +646,116 @@ namespace fefu_laboratory_two {
 		using iterator = ChunkList_iterator<value_type>;
 		using const_iterator = ChunkList_const_iterator<value_type>;
 
-		ChunkList() : first_chunk(new Chunk<value_type>(N)) {};
+		ChunkList() {};
 
+		explicit ChunkList(const Allocator& alloc) : allocator(alloc) {};
 
-		ChunkList(size_type count, const T& value = T(), const Allocator& alloc = Allocator())
-			: first_chunk(new Chunk<value_type, allocator_type>(N))
+		explicit ChunkList(const ChunkPolicy& policy, const Allocator& alloc = Allocator())
+			: allocator(alloc)
 		{
-			int i = 0;
-			auto current_chunk = first_chunk;
-			while (i < count) {
-				current_chunk->allocator = alloc;
-				for (int j = 0; j < N; j++) {
-					current_chunk->list[j] = value;
-					i++;
-					if (i == count) {
-						break;
-					}
-				}
-				if (i < count) {
-					current_chunk->next = new Chunk<value_type, allocator_type>(N);
-					current_chunk = current_chunk->next;
-				}
-			}
+			set_chunk_policy(policy);
+		};
+
+
+		ChunkList(size_type count, const T& value, const Allocator& alloc = Allocator())
+			: allocator(alloc)
+		{
+			reserve(count);
+			insert_n(0, count, [this, &value](value_type* slot) { construct(slot, value); });
 		};
 
 		explicit ChunkList(size_type count, const Allocator& alloc = Allocator())
-			: first_chunk(new Chunk<value_type, allocator_type>(N))
+			: allocator(alloc)
 		{
-			int i = 0;
-			Chunk<value_type, allocator_type>* current_chunk = first_chunk;
-			while (i < count) {
-				current_chunk->allocator = alloc;
-				for (int j = 0; j < N; j++) {
-					current_chunk->list[j] = T();
-					i++;
-					if (i == count)
-						break;
-				}
-				if (i < count) {
-					current_chunk->next = new Chunk<value_type, allocator_type>(N);
-					current_chunk = current_chunk->next;
-				}
-			}
+			reserve(count);
+			insert_n(0, count, [this](value_type* slot) { construct(slot); });
 		};
 
-		template <class InputIt>
+		template <std::input_iterator InputIt>
 		ChunkList(InputIt first, InputIt last, const Allocator& alloc = Allocator()) 
-			: first_chunk(new Chunk<value_type, allocator_type>(N))
+			: allocator(alloc)
 		{
-			Chunk<value_type, allocator_type>* current_chunk = first_chunk;
-			auto it = first;
-			int i = 0;
-			while (it != last) {
-				current_chunk->allocator = alloc;	
-				for (i = 0; i < N && it != last; ++i, ++it) {
-					current_chunk->list[i] = *it;
-					current_chunk->num_of_elements++;
-					list_size++;
-					if (it == last)
-						break;
-				}
-				if (it != last) {
-					current_chunk->next = new Chunk<value_type, allocator_type>(N);
-					current_chunk = current_chunk->next;
-				}
-			}
+			if constexpr (std::forward_iterator<InputIt>)
+				reserve(std::distance(first, last));
+			append_range(first, last);
 		};
 
-		ChunkList(const ChunkList& other)  {
-			first_chunk = new Chunk<value_type>(N);
-			Chunk<value_type>* old_list = other.first_chunk;
-			Chunk<value_type>* new_list = first_chunk;
-
-			while (old_list != nullptr) {
-				new_list->list = old_list->get_data();
-				new_list->chunk_size = old_list->chunk_size;
-				if (old_list->next != nullptr) {
-					new_list->next = new Chunk<value_type>(N);
-					Chunk<value_type>* tmp = new_list;
-					new_list = new_list->next;
-					new_list->prev = tmp;
-				}
-				old_list = old_list->next;
-			}
-			list_size = other.list_size;
+		ChunkList(const ChunkList& other)
+			: allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator))
+		{
+			copy_from(other);
 		};
 
-		ChunkList(const ChunkList& other, const Allocator& alloc) {
-			this = ChunkList(other);
-			Chunk<value_type, allocator_type>* current_chunk = this->first_chunk;
-			while (current_chunk != nullptr) {
-				current_chunk->allocator = alloc;
-				current_chunk = current_chunk->next;
-			}
+		ChunkList(const ChunkList& other, const Allocator& alloc) : allocator(alloc) {
+			copy_from(other);
 		};
 
 
-		ChunkList(ChunkList&& other) {
-			first_chunk = std::move(other.first_chunk);
-			list_size = std::move(other.list_size);
-			other.clear();
+		// Чанки other перецепляются целиком, ничего не выделяется. Со встроенным чанком перенос стоит O(InlineN)
+		ChunkList(ChunkList&& other) noexcept(nothrow_steal) : allocator(other.allocator) {
+			steal(other);
 		};
 
 
-		ChunkList(ChunkList&& other, const Allocator& alloc) {
-			this = ChunkList(other);
-			Chunk<value_type, allocator_type>* current_chunk = first_chunk;
-			while (current_chunk != nullptr) {
-				current_chunk->allocator = alloc;
-				current_chunk = current_chunk->next;
+		// Чанки other перецепляются, только если память можно вернуть через alloc; иначе элементы перемещаются поштучно
+		ChunkList(ChunkList&& other, const Allocator& alloc) : allocator(alloc) {
+			if (allocator == other.allocator) {
+				steal(other);
+				return;
 			}
+			move_from(other);
 		};
 
 		ChunkList(std::initializer_list<T> init, const Allocator& alloc = Allocator())
-			: first_chunk(new Chunk<value_type, allocator_type>(N))
+			: allocator(alloc)
 		{
-			first_chunk->allocator = alloc;
-			auto it = init.begin();
-			Chunk<value_type, allocator_type>* current_chunk = first_chunk;
-			int count = 0;
-			while (it != init.end()) {
-				current_chunk->list[count] = *it;
-				++count;
-				++it;
-				if (count == N) {
-					current_chunk->next = new Chunk<value_type, allocator_type>(N);
-					current_chunk = current_chunk->next;
-					count = 0;
-				}
-			}
-			list_size = init.size();
+			reserve(init.size());
+			append_range(init.begin(), init.end());
 		}
 
 		~ChunkList() {
 			clear();
+			release_slabs();
 		};
 
 		ChunkList& operator=(const ChunkList& other) {
-			(this) = new ChunkList(other);
-			return (*this);
+			if (this == &other)
+				return *this;
+
+			clear();
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value) {
+				// Запас из блоков reserve() принадлежит старому аллокатору
+				if (allocator != other.allocator)
+					release_slabs();
+				allocator = other.allocator;
+			}
+			copy_from(other);
+			return *this;
 		};
 
-		ChunkList& operator=(ChunkList&& other) {
-			first_chunk = std::move(other.first_chunk);
-			list_size = std::move(other.list_size);
-			other.clear();
+		ChunkList& operator=(ChunkList&& other) noexcept(nothrow_move_assign) {
+			if (this == &other)
+				return *this;
 
+			clear();
+			if constexpr (!std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+				&& !std::allocator_traits<Allocator>::is_always_equal::value) {
+				if (allocator != other.allocator) {
+					move_from(other);
+					return *this;
+				}
+			}
+			// Запас и блоки reserve() заменяются запасом other
+			release_slabs();
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value)
+				allocator = other.allocator;
+			steal(other);
 			return *this;
 		};
 
 		ChunkList& operator=(std::initializer_list<T> ilist) {
 			clear();
-			auto it = ilist.begin();
-			Chunk* current_chunk = first_chunk;
-			int count = 0;
-			for (const auto& elem : ilist) {
-				current_chunk->list[count] = elem;
-				++count;
-				if (count == N) {
-					if (current_chunk->next == nullptr) {
-						current_chunk->next = new Chunk<value_type, allocator_type>(N);
-						current_chunk->next->prev = current_chunk;
-					}
-					current_chunk = current_chunk->next;
-					count = 0;
-				}
-			}
-			list_size = ilist.size();
+			append_range(ilist.begin(), ilist.end());
 			return *this;
 		}
 
@@ -612,9 +763,8 @@ namespace fefu_laboratory_two {
 			if (count < 0)
 				throw std::out_of_range("Count argument must be non-negative");
 			clear();
-			for (int i = 0; i < count; i++)
-				push_back(value);
-			list_size = count;
+			reserve(count);
+			insert_n(0, count, [this, &value](value_type* slot) { construct(slot, value); });
 		};
 
 		template <class InputIt>
@@ -632,69 +782,57 @@ namespace fefu_laboratory_two {
 			}
 		}
 
+		// Новая политика действует на чанки, создаваемые после вызова; существующие сохраняют свою ёмкость
+		void set_chunk_policy(const ChunkPolicy& policy) {
+			if (policy.initial_size < 0 || policy.max_size < 0)
+				throw std::invalid_argument("Chunk size must be non-negative");
+			if (policy.initial_size > max_chunk_capacity || policy.max_size > max_chunk_capacity)
+				throw std::invalid_argument("Chunk size is too large");
+
+			chunk_size = policy.initial_size == 0 ? N : policy.initial_size;
+			max_chunk_size = std::max(chunk_size, policy.max_size);
+		}
+
+		ChunkPolicy get_chunk_policy() const noexcept {
+			return ChunkPolicy{ chunk_size, max_chunk_size };
+		}
+
 		allocator_type get_allocator() const noexcept {
-			return first_chunk->allocator;
+			return allocator;
 		};
 
-		Chunk<value_type, allocator_type>* last_chunk() {
-			Chunk<value_type, allocator_type>* current_chunk = first_chunk;
-			while (current_chunk->next != nullptr)
-				current_chunk = current_chunk->next;
-			return current_chunk;
+		Chunk<value_type, allocator_type>* last_chunk() const noexcept {
+			return tail_chunk;
 		}
 
 		reference at(size_type pos) {
-			if (pos >= max_size() || pos < 0) {
+			if (pos >= list_size || pos < 0) {
 				throw std::out_of_range("Out of range");
 			}
-			int chunk_index = pos / chunk_size;
-			int elemnt_index = pos % chunk_size;
-
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (chunk_index > 0) {
-				curr_chunk = curr_chunk->next;
-				chunk_index--;
-			}
-			return curr_chunk->list[elemnt_index];
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(pos, offset);
+			return curr_chunk->list[offset];
 		};
 
 		const_reference at(size_type pos) const {
-			if (pos >= max_size() || pos < 0) {
+			if (pos >= list_size || pos < 0) {
 				throw std::out_of_range("Out of range");
 			}
-			int chunk_index = pos / N;
-			int elemnt_index = pos % N;
-
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (chunk_index > 0) {
-				curr_chunk = curr_chunk->next;
-				chunk_index--;
-			}
-			return curr_chunk->list[elemnt_index];
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(pos, offset);
+			return curr_chunk->list[offset];
 		};
 
 		reference operator[](difference_type pos) {
-			int chunk_index = pos / N;
-			int elemnt_index = pos % N;
-
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (chunk_index > 0) {
-				curr_chunk = curr_chunk->next;
-				chunk_index--;
-			}
-			return curr_chunk->list[elemnt_index];
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(pos, offset);
+			return curr_chunk->list[offset];
 		};
 
 		const_reference operator[](difference_type pos) const {
-			int chunk_index = pos / N;
-			int elemnt_index = pos % N;
-
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (chunk_index > 0) {
-				curr_chunk = curr_chunk->next;
-				chunk_index--;
-			}
-			return curr_chunk->list[elemnt_index];
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(pos, offset);
+			return curr_chunk->list[offset];
 		};
 
 		reference front() {
@@ -730,11 +868,15 @@ namespace fefu_laboratory_two {
 		};
 
 		iterator begin() noexcept {
-			return ChunkList_iterator<T>(this, 0, &at(0));
+			if (list_size == 0)
+				return end();
+			return ChunkList_iterator<T>(this, 0, &first_chunk->list[0]);
 		};
 
 		const_iterator begin() const noexcept {
-			return ChunkList_const_iterator<T>(this, 0, &at(0));
+			if (list_size == 0)
+				return end();
+			return ChunkList_const_iterator<T>(this, 0, &first_chunk->list[0]);
 		};
 
 		const_iterator cbegin() const noexcept { return begin(); };
@@ -754,333 +896,893 @@ namespace fefu_laboratory_two {
 		size_type size() const noexcept { return list_size; };
 
 		size_type max_size() const noexcept {
-			int r = list_size % chunk_size;
-			return (r == 0 ? list_size : list_size + N - r);
-		};
+			size_type capacity = static_cast<size_type>(chunk_size);
+			return (list_size + capacity - 1) / capacity * capacity;
+		};
+
+		// Место под count элементов без обращений к аллокатору: недостающие чанки нарезаются
+		// из одного блока памяти и ждут в запасе, пока push_back/insert до них не дойдут
+		void reserve(size_type count) {
+			size_type available = list_size + spare_capacity;
+			int prev_size = 0;
+			if (first_chunk != nullptr) {
+				Chunk<value_type, allocator_type>* tail = last_chunk();
+				available += tail->chunk_size - tail->num_of_elements;
+				prev_size = tail->chunk_size;
+			}
+			else if (is_inline_free()) {
+				available += InlineN;
+				prev_size = InlineN;
+			}
+			if (count <= available)
+				return;
+
+			Chunk<value_type, allocator_type>* bottom = spare_chunks;
+			while (bottom != nullptr && bottom->next != nullptr)
+				bottom = bottom->next;
+			if (bottom != nullptr)
+				prev_size = bottom->chunk_size;
+
+			allocate_slab(count - available, prev_size, bottom);
+		}
+
+		// reserve(count), после которого буферы запасных чанков впервые касаются num_threads потоков,
+		// каждый — своей непрерывной части. Так страницы ложатся на NUMA-узлы потоков, которые будут с ними работать.
+		// prepare(thread_index) вызывается в потоке до касания, например чтобы задать политику памяти.
+		// Политика потока действует только на память без собственной политики: если аллокатор уже привязал блок
+		// через mbind (NumaAllocator с политикой не Default), узлы по частям задаёт перегрузка с placements
+		template <class Prepare>
+		void reserve_parallel(size_type count, int num_threads, Prepare prepare) {
+			if (num_threads <= 0)
+				throw std::invalid_argument("Thread count must be positive");
+
+			reserve(count);
+			touch_spare_chunks(num_threads, [&prepare](int thread_index, Chunk<value_type, allocator_type>**, Chunk<value_type, allocator_type>**) {
+				prepare(thread_index);
+			});
+		}
+
+		// reserve(count) с явным размещением: часть запаса потока t привязывается к placements[t] через mbind
+		// и касается этим же потоком. Привязка части сильнее и политики блока от аллокатора, и политики потока
+		void reserve_parallel(size_type count, const std::vector<NumaPolicy>& placements) {
+			if (placements.empty())
+				throw std::invalid_argument("Thread count must be positive");
+
+			reserve(count);
+			touch_spare_chunks(static_cast<int>(placements.size()), [&placements](int thread_index,
+				Chunk<value_type, allocator_type>** first, Chunk<value_type, allocator_type>** last) {
+				// Соседние буферы одного блока привязываются одним диапазоном, чтобы не терять страницы на стыках
+				while (first != last) {
+					unsigned char* begin = reinterpret_cast<unsigned char*>((*first)->list);
+					unsigned char* end = begin;
+					for (; first != last && reinterpret_cast<unsigned char*>((*first)->list) == end; ++first)
+						end += (*first)->chunk_size * sizeof(value_type);
+					Numa::bind(begin, end - begin, placements[thread_index]);
+				}
+			});
+		}
+
+		void reserve_parallel(size_type count, int num_threads) {
+			reserve_parallel(count, num_threads, [](int) {});
+		}
+
+		size_type capacity() const noexcept {
+			return total_capacity + spare_capacity;
+		}
+
+		static constexpr bool counters_enabled = ChunkListCounterState::enabled;
+
+		// Снимок счётчиков горячих путей; без CHUNKLIST_ENABLE_COUNTERS всегда нулевой
+		ChunkListCounters counters() const noexcept {
+			return counter_state.snapshot();
+		}
+
+		void reset_counters() noexcept {
+			counter_state.reset();
+		}
+
+		// Один проход по цепочке чанков, элементы не читаются
+		ChunkListStats stats() const {
+			ChunkListStats result;
+			result.size = list_size;
+			result.chunk_count = chunk_count;
+			result.capacity = total_capacity;
+			result.spare_capacity = spare_capacity;
+			result.bytes_allocated = allocated_bytes;
+			result.allocations = allocation_count;
+			result.deallocations = deallocation_count;
+
+			std::size_t run = 0;
+			for (const Chunk<value_type, allocator_type>* chunk = first_chunk; chunk != nullptr; chunk = chunk->next) {
+				std::size_t bucket = static_cast<std::size_t>(chunk->num_of_elements) * 10 / chunk->chunk_size;
+				++result.fill_histogram[std::min<std::size_t>(bucket, 9)];
+				run = chunk->num_of_elements * 2 < chunk->chunk_size ? run + 1 : 0;
+				result.longest_underfilled_run = std::max(result.longest_underfilled_run, run);
+			}
+			return result;
+		}
 
 		void shrink_to_fit() {
-			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
+			if (list_size == 0) {
+				clear();
+				release_slabs();
+				return;
+			}
 
-			Chunk<value_type, allocator_type>* new_chunk = new Chunk<value_type, allocator_type>(N);
-			for (size_type i = 0; i < curr_chunk->chunk_size; ++i) {
-				new_chunk->list[i] = std::move<value_type>(curr_chunk->list[i]);
+			compact();
+			// Запасные чанки отпускаются, а живые чанки из блоков reserve() переезжают в свою память,
+			// чтобы блоки освободились целиком
+			release_slabs();
+			for (Chunk<value_type, allocator_type>* curr_chunk = first_chunk; curr_chunk != nullptr; curr_chunk = curr_chunk->next) {
+				if (curr_chunk->slab != nullptr)
+					curr_chunk = move_out_of_slab(curr_chunk);
 			}
-			new_chunk->num_of_elements = curr_chunk->num_of_elements;
+			release_slabs();
 
-			delete[] curr_chunk->list;
-			curr_chunk->list = new_chunk->list;
-			curr_chunk->next = new_chunk;
+			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
+			if (curr_chunk->num_of_elements < curr_chunk->chunk_size)
+				resize_chunk(curr_chunk, curr_chunk->num_of_elements);
 		}
 
-			Chunk<value_type, allocator_type>* cur = first_chunk;
-			while (cur != nullptr) {
-				Chunk<value_type, allocator_type>* tmp = cur;
-				cur = cur->next;
-				delete tmp;
+		// Перепаковывает элементы в минимальное число чанков: каждый чанк добирает элементы
+		// из следующих, пока не заполнится на target_fill, опустевшие чанки освобождаются
+		void compact(double target_fill = 1.0) {
+			if (target_fill <= 0 || target_fill > 1)
+				throw std::invalid_argument("Target fill must be in (0, 1]");
+
+			[[maybe_unused]] int chunks_before = chunk_count;
+			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
+			while (curr_chunk != nullptr && curr_chunk->next != nullptr) {
+				Chunk<value_type, allocator_type>* next_chunk = curr_chunk->next;
+				int limit = std::max(1, static_cast<int>(curr_chunk->chunk_size * target_fill));
+				if (curr_chunk->num_of_elements >= limit) {
+					curr_chunk = next_chunk;
+					continue;
+				}
+
+				int take = std::min(limit - curr_chunk->num_of_elements, next_chunk->num_of_elements);
+				relocate(next_chunk, next_chunk->begin(), next_chunk->begin() + take, curr_chunk->end());
+				relocate(next_chunk, next_chunk->begin() + take, next_chunk->end(), next_chunk->begin());
+				curr_chunk->num_of_elements += take;
+				next_chunk->num_of_elements -= take;
+				CHUNKLIST_PROBE3(chunk_merge, curr_chunk, next_chunk, take);
+
+				if (next_chunk->num_of_elements == 0)
+					unlink_chunk(next_chunk);
 			}
+			CHUNKLIST_PROBE3(compact, this, chunks_before, chunk_count);
+		}
+
+		// Автоматическое уплотнение: когда средняя заполненность чанков падает ниже threshold,
+		// после удаления вызывается compact(target_fill). threshold == 0 отключает проверку
+		void set_auto_compact(double threshold, double target_fill = 1.0) {
+			if (threshold < 0 || threshold >= target_fill || target_fill > 1)
+				throw std::invalid_argument("Threshold must be in [0, target_fill)");
+			auto_compact_threshold = threshold;
+			auto_compact_fill = target_fill;
+		}
+
+		void clear() noexcept {
+			release_chunks(first_chunk);
 			list_size = 0;
 			first_chunk = nullptr;
+			tail_chunk = nullptr;
 		};
 
 		iterator insert(const_iterator pos, const T& value) {
-			if (pos == cend()) {
-				push_back(value);
-				return end();
-			}
-			int index = pos.get_index();
-			int i = 0;
-			ChunkList_iterator<T> tmpPos = pos.constIteratorToIterator();
-			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			if (curr_chunk->chunk_size > curr_chunk->num_of_elements) {
-				ChunkList_iterator<T> it = ChunkList_iterator<T>(
-					this,
-					list_size - 1,
-					&curr_chunk->list[curr_chunk->chunk_size - 1]
-				);
-				for (; it >= tmpPos; it--, i++)
-					at(list_size - i) = at(list_size - i - 1);
-				list_size++;
-			}
-			else {
-				curr_chunk->next = new Chunk<value_type, allocator_type>(N);
-				ChunkList_iterator<T> it = ChunkList_iterator<T>(
-					this,
-					list_size - 1,
-					&curr_chunk->list[curr_chunk->chunk_size - 1]
-				);
-				Chunk<value_type, allocator_type>* tmp = curr_chunk;
-				curr_chunk = curr_chunk->next;
-				curr_chunk->prev = tmp;
-				list_size++;
-				for (; it >= tmpPos; it--, i++)
-					at(list_size - 1 - i) = at(list_size - i - 2);
-			}
-			at(index) = value;
-			curr_chunk->num_of_elements++;
-			return ChunkList_iterator<T>(this, index, &at(index));
+			return emplace(pos, value);
 		};
 
 		iterator insert(const_iterator pos, T&& value) {
-			if (pos == cend()) {
-				push_back(value);
-				return end();
-			}
-			int index = pos.get_index();
-			int i = 0;
-			ChunkList_iterator<T> tmpPos = pos.constIteratorToIterator();
-			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			if (curr_chunk->chunk_size > curr_chunk->num_of_elements) {
-				ChunkList_iterator<T> it = ChunkList_iterator<T>(
-					this,
-					list_size - 1,
-					&curr_chunk->list[curr_chunk->chunk_size - 1]
-				);
-				for (; it >= tmpPos; it--, i++)
-					at(list_size - i) = at(list_size - i - 1);
-				list_size++;
-			}
-			else {
-				curr_chunk->next = new Chunk<value_type, allocator_type>(N);
-				ChunkList_iterator<T> it = ChunkList_iterator<T>(
-					this,
-					list_size - 1,
-					&curr_chunk->list[curr_chunk->chunk_size - 1]
-				);
-				Chunk<value_type, allocator_type>* tmp = curr_chunk;
-				curr_chunk = curr_chunk->next;
-				curr_chunk->prev = tmp;
-				list_size++;
-				for (; it >= tmpPos; it--, i++)
-					at(list_size - 1 - i) = at(list_size - i - 2);
-			}
-			at(index) = std::move(value);
-			curr_chunk->num_of_elements++;
-			return ChunkList_iterator<T>(this, index, &at(index));
+			return emplace(pos, std::move(value));
 		};
 
 		private:
-		Chunk<value_type, allocator_type>* get_chunk_at_index(size_type index) const {
-			int chunk_index = index / N;
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (chunk_index > 0) {
-				curr_chunk = curr_chunk->next;
-				chunk_index--;
-			}
+		// Чанк с элементом pos и смещение в нём (см. chain_locate); индексация идёт по цепочке за O(число чанков)
+		Chunk<value_type, allocator_type>* locate(size_type pos, int& offset) const {
+			std::size_t hops = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = chain_locate(first_chunk, pos, offset, hops);
+			counter_state.hops(hops);
 			return curr_chunk;
 		}
 
+		Chunk<value_type, allocator_type>* get_chunk_at_index(size_type index) const {
+			int offset = 0;
+			return locate(index, offset);
+		}
+
 		size_type get_start_index_of_chunk(Chunk<value_type, allocator_type>* chunk) const {
 			size_type index = 0;
 			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
+			std::size_t hops = 0;
 			while (curr_chunk != chunk) {
-				index += N;
+				index += curr_chunk->num_of_elements;
 				curr_chunk = curr_chunk->next;
+				++hops;
 			}
+			counter_state.hops(hops);
 			return index;
 		}
 
-		public:
-		iterator insert(const_iterator pos, size_type count, const T& value) {
-			if (count == 0) {
-				return ChunkList_iterator<T>(this, pos.get_index(), &at(pos.get_index()));
+		template <class... Args>
+		void construct(value_type* slot, Args&&... args) {
+			std::allocator_traits<Allocator>::construct(allocator, slot, std::forward<Args>(args)...);
+		}
+
+		void relocate(Chunk<value_type, allocator_type>* chunk, value_type* first, value_type* last, value_type* dest) {
+			counter_state.moves(last - first);
+			chunk->relocate(first, last, dest);
+		}
+
+		Chunk<value_type, allocator_type>* create_chunk() {
+			return create_chunk(chunk_size);
+		}
+
+		Chunk<value_type, allocator_type>* create_chunk(int capacity) {
+			Chunk<value_type, allocator_type>* chunk = nullptr;
+			if (spare_chunks != nullptr && spare_chunks->chunk_size >= capacity) {
+				chunk = spare_chunks;
+				spare_chunks = chunk->next;
+				spare_capacity -= chunk->chunk_size;
+				chunk->next = nullptr;
 			}
-			if (pos == cend()) {
-				for (size_type i = 0; i < count; ++i) {
-					push_back(value);
+			else {
+				node_allocator alloc(allocator);
+				chunk = std::allocator_traits<node_allocator>::allocate(alloc, 1);
+				try {
+					std::allocator_traits<node_allocator>::construct(alloc, chunk, capacity, allocator);
+				}
+				catch (...) {
+					std::allocator_traits<node_allocator>::deallocate(alloc, chunk, 1);
+					throw;
 				}
-				return ChunkList_iterator<T>(this, list_size - 1, &at(list_size - 1));
+				// Заголовок и буфер — два обращения к аллокатору, так же считает и stats()
+				allocation_count += 2;
+				counter_state.allocations(2);
+				CHUNKLIST_PROBE2(chunk_alloc, chunk, capacity);
+				allocated_bytes += sizeof(*chunk) + capacity * sizeof(value_type);
 			}
+			++chunk_count;
+			total_capacity += chunk->chunk_size;
+			return chunk;
+		}
 
-			size_type index = pos.get_index();
-			Chunk<value_type, allocator_type>* curr_chunk = get_chunk_at_index(index);
-			size_type offset = index - get_start_index_of_chunk(curr_chunk);
-
-			while (count > 0) {
-				if (curr_chunk->num_of_elements < N - offset) {
-					size_type num_to_copy = std::min(count, N - offset);
-					std::copy_backward(curr_chunk->list + offset, curr_chunk->list + curr_chunk->num_of_elements,
-						curr_chunk->list + curr_chunk->num_of_elements + num_to_copy);
-					std::fill(curr_chunk->list + offset, curr_chunk->list + offset + num_to_copy, value);
-					count -= num_to_copy;
-					offset = 0;
-					curr_chunk->num_of_elements = N;
-				}
-				else {
-					Chunk<value_type, allocator_type>* new_chunk = new Chunk<value_type, allocator_type>();
-					new_chunk->prev = curr_chunk;
-					new_chunk->next = curr_chunk->next;
-					if (curr_chunk->next != nullptr) {
-						curr_chunk->next->prev = new_chunk;
-					}
-					curr_chunk->next = new_chunk;
-					curr_chunk = new_chunk;
+		// Первый чанк списка: встроенный, если он есть и свободен, иначе обычный
+		Chunk<value_type, allocator_type>* create_first_chunk() {
+			if constexpr (InlineN > 0) {
+				if (!inline_chunk.in_use) {
+					inline_chunk.in_use = true;
+					++chunk_count;
+					total_capacity += InlineN;
+					return &inline_chunk.chunk;
 				}
 			}
+			return create_chunk();
+		}
 
-			list_size += count;
-			return ChunkList_iterator<T>(this, index, &at(index));
+		bool is_inline_free() const noexcept {
+			if constexpr (InlineN > 0)
+				return !inline_chunk.in_use;
+			return false;
 		}
 
-		Chunk<value_type, allocator_type>* insert_chunk_after(Chunk<value_type, allocator_type>* chunk) {
-			Chunk<value_type, allocator_type>* new_chunk = new Chunk<value_type, allocator_type>();
-			new_chunk->next = chunk->next;
-			new_chunk->prev = chunk;
-			if (chunk->next != nullptr) {
-				chunk->next->prev = new_chunk;
+		bool is_inline(const Chunk<value_type, allocator_type>* chunk) const noexcept {
+			if constexpr (InlineN > 0)
+				return chunk == &inline_chunk.chunk;
+			return false;
+		}
+
+		void destroy_chunk(Chunk<value_type, allocator_type>* chunk) noexcept {
+			total_capacity -= chunk->chunk_size;
+			--chunk_count;
+			if constexpr (InlineN > 0) {
+				if (is_inline(chunk)) {
+					chunk->clear();
+					chunk->prev = nullptr;
+					chunk->next = nullptr;
+					inline_chunk.in_use = false;
+					return;
+				}
 			}
-			chunk->next = new_chunk;
-			return new_chunk;
+			if (!chunk->owns_list) {
+				// Чанк из блока reserve() возвращается в запас
+				chunk->clear();
+				chunk->prev = nullptr;
+				chunk->next = spare_chunks;
+				spare_chunks = chunk;
+				spare_capacity += chunk->chunk_size;
+				return;
+			}
+			CHUNKLIST_PROBE2(chunk_free, chunk, chunk->chunk_size);
+			deallocation_count += 2;
+			allocated_bytes -= sizeof(*chunk) + chunk->chunk_size * sizeof(value_type);
+			node_allocator alloc(allocator);
+			std::allocator_traits<node_allocator>::destroy(alloc, chunk);
+			std::allocator_traits<node_allocator>::deallocate(alloc, chunk, 1);
 		}
-		template <class InputIt>
-		iterator insert(const_iterator pos, InputIt first, InputIt last) {
-			size_type index = pos.get_index();
-			Chunk<value_type, allocator_type>* curr_chunk = get_chunk_at_index(index);
-			size_type offset = index - get_start_index_of_chunk(curr_chunk);
 
-			while (first != last) {
-				if (offset == N) {
-					curr_chunk = insert_chunk_after(curr_chunk);
-					offset = 0;
+		// Забирает всё содержимое other, *this должен быть пуст. Элементы встроенного чанка
+		// переносятся, остальные чанки перецепляются без копирования
+		void steal(ChunkList& other) noexcept(nothrow_steal) {
+			first_chunk = other.first_chunk;
+			tail_chunk = other.tail_chunk;
+			list_size = other.list_size;
+			chunk_count = other.chunk_count;
+			total_capacity = other.total_capacity;
+			chunk_size = other.chunk_size;
+			max_chunk_size = other.max_chunk_size;
+			auto_compact_threshold = other.auto_compact_threshold;
+			auto_compact_fill = other.auto_compact_fill;
+			capacity_limit = other.capacity_limit;
+			spare_chunks = other.spare_chunks;
+			spare_capacity = other.spare_capacity;
+			slabs = other.slabs;
+			allocated_bytes = other.allocated_bytes;
+
+			if constexpr (InlineN > 0) {
+				if (other.is_inline(other.first_chunk)) {
+					Chunk<value_type, allocator_type>& from = other.inline_chunk.chunk;
+					Chunk<value_type, allocator_type>& to = inline_chunk.chunk;
+					relocate(&from, from.begin(), from.end(), to.list);
+					to.num_of_elements = from.num_of_elements;
+					to.next = from.next;
+					if (to.next != nullptr)
+						to.next->prev = &to;
+					else
+						tail_chunk = &to;
+					inline_chunk.in_use = true;
+					first_chunk = &to;
+
+					from.num_of_elements = 0;
+					from.next = nullptr;
+					other.inline_chunk.in_use = false;
 				}
-				if (curr_chunk->num_of_elements < N - offset) {
-					size_type num_to_copy = std::min(static_cast<size_type>(std::distance(first, last)), N - offset);
-					std::copy(first, first + num_to_copy, curr_chunk->list + offset);
-					std::advance(first, num_to_copy);
-					offset += num_to_copy;
-					curr_chunk->num_of_elements += num_to_copy;
+			}
+
+			other.first_chunk = nullptr;
+			other.tail_chunk = nullptr;
+			other.list_size = 0;
+			other.chunk_count = 0;
+			other.total_capacity = 0;
+			other.spare_chunks = nullptr;
+			other.spare_capacity = 0;
+			other.slabs = nullptr;
+			other.allocated_bytes = 0;
+		}
+
+		void resize_chunk(Chunk<value_type, allocator_type>* chunk, int capacity) {
+			if (!chunk->owns_list)
+				return;
+			total_capacity -= chunk->chunk_size;
+			allocated_bytes -= chunk->chunk_size * sizeof(value_type);
+			chunk->resize(capacity);
+			total_capacity += chunk->chunk_size;
+			allocated_bytes += chunk->chunk_size * sizeof(value_type);
+			++allocation_count;
+			++deallocation_count;
+			counter_state.allocations(1);
+		}
+
+		// Ёмкость чанка, который встаёт после чанка ёмкости prev_size (0 — чанков ещё нет):
+		// при геометрической политике удваивается до max_chunk_size
+		int grown_size(int prev_size) const noexcept {
+			if (prev_size == 0 || max_chunk_size == chunk_size)
+				return chunk_size;
+			if (prev_size >= max_chunk_size - prev_size)
+				return max_chunk_size;
+			return std::max(prev_size * 2, chunk_size);
+		}
+
+		int grown_chunk_size(const Chunk<value_type, allocator_type>* chunk) const noexcept {
+			return grown_size(chunk == nullptr ? 0 : chunk->chunk_size);
+		}
+
+		// Один блок под чанки общей ёмкостью не меньше count, растущие по политике после чанка ёмкости prev_size:
+		// [ChunkSlab][заголовки чанков][буферы подряд]. Чанки встают в запас после after (nullptr — в начало запаса)
+		void allocate_slab(size_type count, int prev_size, Chunk<value_type, allocator_type>* after) {
+			using chunk_type = Chunk<value_type, allocator_type>;
+			size_type num_of_chunks = 0;
+			size_type elements = 0;
+			for (int size = prev_size; elements < count; ++num_of_chunks) {
+				size = grown_size(size);
+				elements += size;
+			}
+
+			std::size_t headers = (sizeof(ChunkSlab) + alignof(chunk_type) - 1) / alignof(chunk_type) * alignof(chunk_type);
+			std::size_t buffers = headers + num_of_chunks * sizeof(chunk_type);
+			buffers = (buffers + alignof(value_type) - 1) / alignof(value_type) * alignof(value_type);
+			std::size_t bytes = buffers + elements * sizeof(value_type);
+
+			slab_allocator alloc(allocator);
+			unsigned char* raw = std::allocator_traits<slab_allocator>::allocate(alloc, bytes);
+			ChunkSlab* slab = ::new (raw) ChunkSlab{ slabs, bytes, static_cast<int>(num_of_chunks) + 1 };
+			slabs = slab;
+			++allocation_count;
+			allocated_bytes += bytes;
+			counter_state.allocations(1);
+			CHUNKLIST_PROBE3(reserve_slab, this, bytes, num_of_chunks);
+
+			chunk_type* header = reinterpret_cast<chunk_type*>(raw + headers);
+			value_type* storage = reinterpret_cast<value_type*>(raw + buffers);
+			chunk_type* tail = after;
+			chunk_type* rest = after == nullptr ? spare_chunks : nullptr;
+			for (int size = prev_size; num_of_chunks > 0; --num_of_chunks) {
+				size = grown_size(size);
+				chunk_type* chunk = ::new (header++) chunk_type(storage, size, allocator);
+				chunk->slab = slab;
+				storage += size;
+				spare_capacity += size;
+				if (tail == nullptr)
+					spare_chunks = chunk;
+				else
+					tail->next = chunk;
+				tail = chunk;
+			}
+			tail->next = rest;
+		}
+
+		// Делит запасные чанки между num_threads потоками поровну и подряд. Поток t вызывает
+		// prepare(t, first, last) для своей части [first, last), затем касается её буферов
+		template <class Prepare>
+		void touch_spare_chunks(int num_threads, Prepare prepare) {
+			std::vector<Chunk<value_type, allocator_type>*> chunks;
+			for (Chunk<value_type, allocator_type>* chunk = spare_chunks; chunk != nullptr; chunk = chunk->next)
+				chunks.push_back(chunk);
+
+			std::vector<std::thread> threads;
+			std::vector<std::exception_ptr> errors(num_threads);
+			for (int t = 0; t < num_threads; ++t) {
+				threads.emplace_back([&, t]() {
+					try {
+						Chunk<value_type, allocator_type>** first = chunks.data() + chunks.size() * t / num_threads;
+						Chunk<value_type, allocator_type>** last = chunks.data() + chunks.size() * (t + 1) / num_threads;
+						prepare(t, first, last);
+						for (; first != last; ++first)
+							touch(*first);
+					}
+					catch (...) {
+						errors[t] = std::current_exception();
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+			for (std::exception_ptr& error : errors)
+				if (error)
+					std::rethrow_exception(error);
+		}
+
+		// Пишет по байту в каждую страницу сырого буфера чанка, чтобы ядро выделило под него физическую память
+		static void touch(Chunk<value_type, allocator_type>* chunk) noexcept {
+			volatile unsigned char* begin = reinterpret_cast<unsigned char*>(chunk->list);
+			std::size_t bytes = chunk->chunk_size * sizeof(value_type);
+			std::size_t page = Numa::page_size();
+			for (std::size_t offset = 0; offset < bytes; offset += page)
+				begin[offset] = 0;
+		}
+
+		// Уничтожает запасные чанки и отпускает свои блоки. Блок освобождается, когда в нём не осталось живых чанков;
+		// чанки, перецепленные в другие списки, держат его до своего уничтожения
+		void release_slabs() noexcept {
+			while (spare_chunks != nullptr) {
+				Chunk<value_type, allocator_type>* chunk = spare_chunks;
+				spare_chunks = chunk->next;
+				ChunkSlab* slab = chunk->slab;
+				chunk->~Chunk();
+				release_slab(slab);
+			}
+			spare_capacity = 0;
+
+			while (slabs != nullptr) {
+				ChunkSlab* slab = slabs;
+				slabs = slab->next;
+				allocated_bytes -= slab->bytes;
+				release_slab(slab);
+			}
+		}
+
+		// Заменяет чанк из блока reserve() обычным чанком по числу элементов и отпускает его блок
+		Chunk<value_type, allocator_type>* move_out_of_slab(Chunk<value_type, allocator_type>* from) {
+			Chunk<value_type, allocator_type>* to = create_chunk(from->num_of_elements);
+			relocate(from, from->begin(), from->end(), to->list);
+			to->num_of_elements = from->num_of_elements;
+			from->num_of_elements = 0;
+
+			chain_link_after(first_chunk, tail_chunk, from, to);
+			chain_unlink(first_chunk, tail_chunk, from);
+			// Мимо запаса: иначе следующий create_chunk снова взял бы чанк из блока
+			total_capacity -= from->chunk_size;
+			--chunk_count;
+			ChunkSlab* slab = from->slab;
+			from->~Chunk();
+			release_slab(slab);
+			return to;
+		}
+
+		void release_slab(ChunkSlab* slab) noexcept {
+			if (--slab->refs > 0)
+				return;
+			std::size_t bytes = slab->bytes;
+			++deallocation_count;
+			slab->~ChunkSlab();
+			slab_allocator alloc(allocator);
+			std::allocator_traits<slab_allocator>::deallocate(alloc, reinterpret_cast<unsigned char*>(slab), bytes);
+		}
+
+		// Переносит элементы встроенного чанка в обычный, чтобы цепочку чанков можно было перецепить в другой список
+		void evict_inline() {
+			if (first_chunk == nullptr || !is_inline(first_chunk))
+				return;
+
+			Chunk<value_type, allocator_type>* from = first_chunk;
+			Chunk<value_type, allocator_type>* to = create_chunk(std::max(chunk_size, from->num_of_elements));
+			relocate(from, from->begin(), from->end(), to->list);
+			to->num_of_elements = from->num_of_elements;
+			from->num_of_elements = 0;
+			chain_link_after(first_chunk, tail_chunk, from, to);
+			chain_unlink(first_chunk, tail_chunk, from);
+			destroy_chunk(from);
+		}
+
+		// Отцепляет от other чанки от start до конца и переносит их учёт в этот список.
+		// Цепочку вставляет вызывающий; встроенного чанка в ней быть не должно
+		void adopt_chain(ChunkList& other, Chunk<value_type, allocator_type>* start) noexcept {
+			if (start->prev != nullptr)
+				start->prev->next = nullptr;
+			else
+				other.first_chunk = nullptr;
+			other.tail_chunk = start->prev;
+			start->prev = nullptr;
+
+			for (Chunk<value_type, allocator_type>* chunk = start; chunk != nullptr; chunk = chunk->next) {
+				other.list_size -= chunk->num_of_elements;
+				list_size += chunk->num_of_elements;
+				--other.chunk_count;
+				++chunk_count;
+				other.total_capacity -= chunk->chunk_size;
+				total_capacity += chunk->chunk_size;
+				if (chunk->owns_list) {
+					std::size_t bytes = sizeof(*chunk) + chunk->chunk_size * sizeof(value_type);
+					other.allocated_bytes -= bytes;
+					allocated_bytes += bytes;
 				}
 			}
+		}
 
-			list_size += std::distance(first, last);
-			return ChunkList_iterator<T>(this, index, &at(index));
+		// Разрезает чанк так, чтобы позиция index оказалась в конце чанка; возвращает этот чанк
+		Chunk<value_type, allocator_type>* split_at_index(size_type index) {
+			if (first_chunk == nullptr)
+				first_chunk = tail_chunk = create_first_chunk();
+
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(index, offset);
+			if (offset == 0 && curr_chunk->prev != nullptr)
+				return curr_chunk->prev;
+			if (offset < curr_chunk->num_of_elements) {
+				Chunk<value_type, allocator_type>* tail = insert_chunk_after(curr_chunk, curr_chunk->chunk_size);
+				relocate(curr_chunk, curr_chunk->begin() + offset, curr_chunk->end(), tail->list);
+				tail->num_of_elements = curr_chunk->num_of_elements - offset;
+				curr_chunk->num_of_elements = offset;
+				CHUNKLIST_PROBE3(chunk_split, curr_chunk, tail, tail->num_of_elements);
+			}
+			return curr_chunk;
 		}
 
-		iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
-			size_type index = pos.get_index();
-			Chunk<value_type, allocator_type>* curr_chunk = get_chunk_at_index(index);
-			size_type offset = index - get_start_index_of_chunk(curr_chunk);
+		// Вставляет count элементов после позиции index: хвост чанка отрезается один раз,
+		// новые элементы дописываются в свободное место и в новые чанки. fill(slot) конструирует элемент в очередном сыром слоте
+		template <class Fill>
+		void insert_n(size_type index, size_type count, Fill fill) {
+			if (count == 0)
+				return;
 
-			for (const auto& value : ilist) {
-				if (offset == N) {
+			CHUNKLIST_PROBE3(bulk_insert, this, index, count);
+			Chunk<value_type, allocator_type>* curr_chunk = split_at_index(index);
+			for (size_type i = 0; i < count; ++i) {
+				if (curr_chunk->num_of_elements == curr_chunk->chunk_size)
 					curr_chunk = insert_chunk_after(curr_chunk);
-					offset = 0;
+				fill(curr_chunk->end());
+				++curr_chunk->num_of_elements;
+			}
+			list_size += count;
+		}
+
+		// Обрезает список до new_size элементов, освобождая хвостовые чанки
+		void truncate(size_type new_size) {
+			if (new_size < list_size)
+				truncate_back(list_size - new_size);
+		}
+
+		// Режим с лимитом: самый старый чанк теряет элементы и перецепляется в конец как новый хвост
+		Chunk<value_type, allocator_type>* recycle_front_chunk() {
+			Chunk<value_type, allocator_type>* oldest = first_chunk;
+			if (oldest == tail_chunk || is_inline(oldest)) {
+				// Встроенный чанк не может стать хвостом: он освобождается, а хвост берётся обычным путём
+				if (oldest != tail_chunk) {
+					list_size -= oldest->num_of_elements;
+					unlink_chunk(oldest);
 				}
-				if (curr_chunk->num_of_elements < N - offset) {
-					curr_chunk->list[offset] = value;
-					++offset;
-					++curr_chunk->num_of_elements;
+				return insert_chunk_after(tail_chunk);
+			}
+
+			list_size -= oldest->num_of_elements;
+			oldest->clear();
+			chain_unlink(first_chunk, tail_chunk, oldest);
+			chain_link_after(first_chunk, tail_chunk, tail_chunk, oldest);
+			return oldest;
+		}
+
+		void unlink_chunk(Chunk<value_type, allocator_type>* chunk) noexcept {
+			chain_unlink(first_chunk, tail_chunk, chunk);
+			destroy_chunk(chunk);
+		}
+
+		// Освобождает слот под элемент с индексом index. Сдвиг идёт только внутри одного чанка,
+		// заполненный чанк делится пополам
+		value_type* insert_slot(size_type index) {
+			if (first_chunk == nullptr)
+				first_chunk = tail_chunk = create_first_chunk();
+
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(index, offset);
+			if (offset == 0 && curr_chunk->prev != nullptr
+				&& curr_chunk->prev->num_of_elements < curr_chunk->prev->chunk_size) {
+				curr_chunk = curr_chunk->prev;
+				offset = curr_chunk->num_of_elements;
+			}
+			else if (curr_chunk->num_of_elements == curr_chunk->chunk_size) {
+				Chunk<value_type, allocator_type>* new_chunk = insert_chunk_after(curr_chunk, curr_chunk->chunk_size);
+				int half = offset == curr_chunk->num_of_elements ? curr_chunk->num_of_elements : curr_chunk->num_of_elements / 2;
+				relocate(curr_chunk, curr_chunk->begin() + half, curr_chunk->end(), new_chunk->list);
+				new_chunk->num_of_elements = curr_chunk->num_of_elements - half;
+				curr_chunk->num_of_elements = half;
+				CHUNKLIST_PROBE3(chunk_split, curr_chunk, new_chunk, new_chunk->num_of_elements);
+				// У чанка ёмкости 1 половина пуста: элемент целиком ушёл в new_chunk, новый встаёт в опустевший чанк
+				if (offset >= half && half > 0) {
+					curr_chunk = new_chunk;
+					offset -= half;
 				}
 			}
 
-			list_size += ilist.size();
-			return ChunkList_iterator<T>(this, index, &at(index));
+			relocate(curr_chunk, curr_chunk->begin() + offset, curr_chunk->end(), curr_chunk->begin() + offset + 1);
+			curr_chunk->num_of_elements++;
+			list_size++;
+			return &curr_chunk->list[offset];
 		}
 
-		template <class... Args>
-		iterator emplace(const_iterator pos, Args&&... args) {
-			return insert(pos, T(std::forward<Args>(args)...));
+		// Копирует элементы other в пустой список
+		void copy_from(const ChunkList& other) {
+			set_chunk_policy(other.get_chunk_policy());
+			reserve(other.list_size);
+			for (Chunk<value_type, allocator_type>* old_list = other.first_chunk; old_list != nullptr; old_list = old_list->next)
+				append_range(old_list->begin(), old_list->end());
 		}
 
-		iterator erase(const_iterator pos) {
-			auto index = pos.get_index();
+		// Перемещает элементы other в пустой список поштучно, когда аллокаторы не совпадают
+		void move_from(ChunkList& other) {
+			set_chunk_policy(other.get_chunk_policy());
+			reserve(other.list_size);
+			for (Chunk<value_type, allocator_type>* old_list = other.first_chunk; old_list != nullptr; old_list = old_list->next)
+				append_range(std::make_move_iterator(old_list->begin()), std::make_move_iterator(old_list->end()));
+			other.clear();
+		}
+
+		template <class InputIt>
+		void append_range(InputIt first, InputIt last) {
+			if (first == last)
+				return;
+			if (first_chunk == nullptr)
+				first_chunk = tail_chunk = create_first_chunk();
+
 			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			curr_chunk->num_of_elements--;
+			for (; first != last; ++first) {
+				if (curr_chunk->num_of_elements == curr_chunk->chunk_size)
+					curr_chunk = insert_chunk_after(curr_chunk);
+				curr_chunk->construct(curr_chunk->end(), *first);
+				++curr_chunk->num_of_elements;
+				list_size++;
+			}
+		}
 
-			if (index + 1 == list_size) {
-				list_size--;
-				return end();
+		void maybe_auto_compact() {
+			if (auto_compact_threshold > 0 && chunk_count > 1
+				&& list_size < auto_compact_threshold * total_capacity)
+				compact(auto_compact_fill);
+		}
+
+		void release_chunks(Chunk<value_type, allocator_type>* chunk) noexcept {
+			while (chunk != nullptr) {
+				Chunk<value_type, allocator_type>* tmp = chunk;
+				chunk = chunk->next;
+				destroy_chunk(tmp);
 			}
+		}
 
-			for (int i = index + 1; i < list_size; i++) {
-				at(i - 1) = at(i);
+		// Потоковое удаление: курсор чтения идёт по всем элементам начиная с (start, offset),
+		// курсор записи переносит выживших вперёд. Опустевшие хвостовые чанки освобождаются одним проходом.
+		template <class Pred>
+		size_type compact_from(Chunk<value_type, allocator_type>* start, int offset, Pred pred) {
+			if (start == nullptr)
+				return 0;
+
+			Chunk<value_type, allocator_type>* read_chunk = start;
+			Chunk<value_type, allocator_type>* write_chunk = start;
+			int read_index = offset;
+			int write_index = offset;
+			size_type removed = 0;
+
+			while (read_chunk != nullptr) {
+				for (; read_index < read_chunk->num_of_elements; ++read_index) {
+					value_type* elem = read_chunk->list + read_index;
+					if (pred(*elem)) {
+						read_chunk->destroy(elem, elem + 1);
+						++removed;
+						continue;
+					}
+					if (removed == 0) {
+						// До первого удаления элементы остаются на своих местах
+						write_chunk = read_chunk;
+						write_index = read_index + 1;
+						continue;
+					}
+					if (write_index == write_chunk->chunk_size) {
+						write_chunk->num_of_elements = write_chunk->chunk_size;
+						write_chunk = write_chunk->next;
+						write_index = 0;
+					}
+					if (write_chunk != read_chunk || write_index != read_index)
+						relocate(read_chunk, elem, elem + 1, write_chunk->list + write_index);
+					++write_index;
+				}
+				// Всё содержимое пройденного чанка перенесено или уничтожено
+				if (read_chunk != write_chunk)
+					read_chunk->num_of_elements = 0;
+				read_chunk = read_chunk->next;
+				read_index = 0;
 			}
 
-			if (curr_chunk->num_of_elements == 0) {
-				curr_chunk = curr_chunk->prev;
-				delete curr_chunk->next;
-				curr_chunk->next = nullptr;
+			if (removed == 0)
+				return 0;
+
+			write_chunk->num_of_elements = write_index;
+			if (write_index == 0 && write_chunk->prev != nullptr)
+				write_chunk = write_chunk->prev;
+			release_chunks(write_chunk->next);
+			write_chunk->next = nullptr;
+			tail_chunk = write_chunk;
+
+			list_size -= removed;
+			CHUNKLIST_PROBE2(bulk_erase, this, removed);
+			maybe_auto_compact();
+			return removed;
+		}
+
+		public:
+		iterator insert(const_iterator pos, size_type count, const T& value) {
+			size_type index = pos == cend() ? list_size : pos.get_index();
+			insert_n(index, count, [this, &value](value_type* slot) { construct(slot, value); });
+			if (index >= list_size)
+				return end();
+			return ChunkList_iterator<T>(this, index, &at(index));
+		}
+
+		Chunk<value_type, allocator_type>* insert_chunk_after(Chunk<value_type, allocator_type>* chunk) {
+			return insert_chunk_after(chunk, grown_chunk_size(chunk));
+		}
+
+		Chunk<value_type, allocator_type>* insert_chunk_after(Chunk<value_type, allocator_type>* chunk, int capacity) {
+			Chunk<value_type, allocator_type>* new_chunk = create_chunk(capacity);
+			chain_link_after(first_chunk, tail_chunk, chunk, new_chunk);
+			return new_chunk;
+		}
+
+		template <std::input_iterator InputIt>
+		iterator insert(const_iterator pos, InputIt first, InputIt last) {
+			size_type index = pos == cend() ? list_size : pos.get_index();
+			size_type count = std::distance(first, last);
+			insert_n(index, count, [this, &first](value_type* slot) { construct(slot, *first++); });
+			if (index >= list_size)
+				return end();
+			return ChunkList_iterator<T>(this, index, &at(index));
+		}
+
+		iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+			return insert(pos, ilist.begin(), ilist.end());
+		}
+
+		template <class... Args>
+		iterator emplace(const_iterator pos, Args&&... args) {
+			size_type index = pos == cend() ? list_size : pos.get_index();
+			value_type* slot = insert_slot(index);
+			try {
+				construct(slot, std::forward<Args>(args)...);
 			}
+			catch (...) {
+				// Конструктор бросил: закрываем освобождённый слот обратно
+				int offset = 0;
+				Chunk<value_type, allocator_type>* curr_chunk = locate(index, offset);
+				relocate(curr_chunk, slot + 1, curr_chunk->end(), slot);
+				curr_chunk->num_of_elements--;
+				list_size--;
+				throw;
+			}
+			return ChunkList_iterator<T>(this, index, slot);
+		}
 
+		iterator erase(const_iterator pos) {
+			size_type index = pos.get_index();
+			int offset = 0;
+			Chunk<value_type, allocator_type>* curr_chunk = locate(index, offset);
+			curr_chunk->destroy(curr_chunk->begin() + offset, curr_chunk->begin() + offset + 1);
+			relocate(curr_chunk, curr_chunk->begin() + offset + 1, curr_chunk->end(), curr_chunk->begin() + offset);
+			curr_chunk->num_of_elements--;
 			list_size--;
+
+			if (curr_chunk->num_of_elements == 0 && chunk_count > 1)
+				unlink_chunk(curr_chunk);
+			maybe_auto_compact();
+
+			if (index == list_size)
+				return end();
 			return ChunkList_iterator<T>(this, index, &at(index));
 		};
 
 		iterator erase(const_iterator first, const_iterator last) {
-			auto start_index = first.get_index();
-			auto end_index = last.get_index();
-
-			// Сдвигаем элементы влево, удаляя элементы в указанном диапазоне
-			size_type shift = end_index - start_index + 1;
-			for (size_type i = end_index + 1; i < list_size; ++i) {
-				at(i - shift) = at(i);
+			size_type start_index = first == cend() ? list_size : first.get_index();
+			size_type end_index = last == cend() ? list_size : last.get_index();
+			if (start_index >= end_index) {
+				return start_index >= list_size ? end() : ChunkList_iterator<T>(this, start_index, &at(start_index));
 			}
 
-			// Обновляем переменную общее кол-во элементов
-			list_size -= shift;
-
-			// Проверяем и обновляем чанки при необходимости
+			// Удаляем первые count элементов, начиная с start_index, и одним проходом сдвигаем хвост
+			size_type count = end_index - start_index;
 			Chunk<value_type, allocator_type>* start_chunk = get_chunk_at_index(start_index);
-			Chunk<value_type, allocator_type>* end_chunk = get_chunk_at_index(end_index);
-			if (end_chunk != start_chunk) {
-				start_chunk->next = end_chunk->next;
-				if (end_chunk->next != nullptr) {
-					end_chunk->next->prev = start_chunk;
-				}
-				else {
-					end_chunk = start_chunk;
-				}
-			}
-			end_chunk->num_of_elements -= shift - (end_index % N) - 1;
+			compact_from(start_chunk, start_index - get_start_index_of_chunk(start_chunk),
+				[&count](const value_type&) {
+					if (count == 0)
+						return false;
+					--count;
+					return true;
+				});
 
-			// Возвращаем итератор, указывающий на первый элемент после удаленного диапазона
+			if (start_index >= list_size)
+				return end();
 			return ChunkList_iterator<T>(this, start_index, &at(start_index));
 		}
 
-		void push_back(const T& value) {
-			if (first_chunk == nullptr) {
-				first_chunk = new Chunk<value_type, allocator_type>(N);
-			}
+		template <class Pred>
+		size_type remove_if(Pred pred) {
+			return compact_from(first_chunk, 0, pred);
+		}
 
-			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			if (curr_chunk->num_of_elements == N) {
-				curr_chunk->next = new Chunk<value_type, allocator_type>(N);
-				Chunk<value_type, allocator_type>* prev = curr_chunk;
-				curr_chunk = curr_chunk->next;
-				curr_chunk->prev = prev;
-			}
-			curr_chunk->list[curr_chunk->num_of_elements++] = value;
-			list_size++;
+		template <class U>
+		size_type remove(const U& value) {
+			return remove_if([&value](const value_type& elem) { return elem == value; });
 		}
 
-		void push_back(T&& value) {
-			if (first_chunk == nullptr)
-				first_chunk = new Chunk<value_type, allocator_type>(N);
+		void push_back(const T& value) {
+			emplace_back(value);
+		}
 
-			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			if (curr_chunk->num_of_elements == N)
-			{
-				curr_chunk->next = new Chunk<value_type, allocator_type>(N);
-				Chunk<value_type, allocator_type>* prev = curr_chunk;
-				curr_chunk = curr_chunk->next;
-				curr_chunk->prev = prev;
-			}
-			curr_chunk->list[curr_chunk->num_of_elements++] = std::move(value);
-			list_size++;
+		void push_back(T&& value) {
+			emplace_back(std::move(value));
 		};
 
+		// Элемент конструируется прямо в слоте последнего чанка, без временного объекта
 		template <class... Args>
 		reference emplace_back(Args&&... args) {
-			if (first_chunk == nullptr) {
-				first_chunk = new Chunk<value_type, allocator_type>(N);
-			}
+			if (first_chunk == nullptr)
+				first_chunk = tail_chunk = create_first_chunk();
 
 			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			if (curr_chunk->num_of_elements == N) {
-				curr_chunk->next = new Chunk<value_type, allocator_type>(N);
-				curr_chunk = curr_chunk->next;
+			if (curr_chunk->num_of_elements == curr_chunk->chunk_size) {
+				if (capacity_limit != 0 && total_capacity + grown_chunk_size(curr_chunk) > capacity_limit)
+					curr_chunk = recycle_front_chunk();
+				else
+					curr_chunk = insert_chunk_after(curr_chunk);
 			}
 
-			curr_chunk->list[curr_chunk->num_of_elements++] = value_type(std::forward<Args>(args)...);;
+			curr_chunk->construct(curr_chunk->end(), std::forward<Args>(args)...);
+			++curr_chunk->num_of_elements;
 			list_size++;
 			return curr_chunk->list[curr_chunk->num_of_elements - 1];
 		}
@@ -1092,13 +1794,11 @@ namespace fefu_laboratory_two {
 
 			list_size--;
 			Chunk<value_type, allocator_type>* curr_chunk = last_chunk();
-			curr_chunk->list[curr_chunk->num_of_elements - 1] = (value_type)nullptr;
+			curr_chunk->destroy(curr_chunk->end() - 1, curr_chunk->end());
 			curr_chunk->num_of_elements--;
 
 			if (curr_chunk->num_of_elements == 0 && first_chunk != curr_chunk) {
-				Chunk<value_type, allocator_type>* prev_chunk = curr_chunk->prev;
-				delete curr_chunk;
-				prev_chunk->next = nullptr;
+				unlink_chunk(curr_chunk);
 			}
 		}
 
@@ -1112,71 +1812,272 @@ namespace fefu_laboratory_two {
 
 		template <class... Args>
 		reference emplace_front(Args&&... args) {
-			auto it = insert(cbegin(), value_type(std::forward<Args>(args)...));
-			return *it;
+			return *emplace(cbegin(), std::forward<Args>(args)...);
 		};
 
 		void pop_front() {
 			erase(cbegin());
 		};
 
-		void resize(size_type count) {
-			if (count < 0)
-				throw std::invalid_argument("Count can not be negative");
+		// Удаляет первые n элементов: целые чанки отцепляются за O(n / N), сдвигается только граничный чанк
+		void drop_front(size_type n) {
+			n = std::min<size_type>(n, list_size);
+			if (n == 0)
+				return;
+			if (n == list_size) {
+				truncate_back(n);
+				return;
+			}
 
+			CHUNKLIST_PROBE2(bulk_erase, this, n);
+			list_size -= n;
+			while (n >= first_chunk->num_of_elements) {
+				n -= first_chunk->num_of_elements;
+				unlink_chunk(first_chunk);
+			}
+			// Граница пришлась на начало чанка: сдвигать нечего
+			if (n == 0)
+				return;
 			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
+			curr_chunk->destroy(curr_chunk->begin(), curr_chunk->begin() + n);
+			relocate(curr_chunk, curr_chunk->begin() + n, curr_chunk->end(), curr_chunk->begin());
+			curr_chunk->num_of_elements -= n;
+		}
 
-			while (curr_chunk != nullptr) {
-				curr_chunk->resize(count);
-				curr_chunk = curr_chunk->next;
+		// Удаляет последние n элементов, проходя чанки с хвоста: O(n / N)
+		void truncate_back(size_type n) {
+			n = std::min<size_type>(n, list_size);
+			if (n == 0)
+				return;
+
+			CHUNKLIST_PROBE2(bulk_erase, this, n);
+			list_size -= n;
+			while (tail_chunk != first_chunk && n >= tail_chunk->num_of_elements) {
+				n -= tail_chunk->num_of_elements;
+				unlink_chunk(tail_chunk);
 			}
+			tail_chunk->destroy(tail_chunk->end() - n, tail_chunk->end());
+			tail_chunk->num_of_elements -= n;
+		}
 
-			if (count < N) {
-				list_size = 0;
+		// Ограниченный режим для скользящих окон: когда push_back/emplace_back потребовал бы новый чанк
+		// сверх limit элементов ёмкости, самый старый чанк вытесняется вместе с элементами и переиспользуется
+		// как новый хвост, без обращения к аллокатору. Последний полный чанк не вытесняется никогда.
+		// Остальные вставки лимит не проверяют. 0 — без лимита
+		void set_capacity_limit(size_type limit) {
+			capacity_limit = limit;
+			while (limit != 0 && total_capacity > limit && first_chunk != tail_chunk) {
+				list_size -= first_chunk->num_of_elements;
+				unlink_chunk(first_chunk);
+			}
+		}
 
-				curr_chunk = first_chunk;
-				while (curr_chunk != nullptr) {
-					list_size += curr_chunk->num_of_elements;
-					curr_chunk = curr_chunk->next;
+		size_type get_capacity_limit() const noexcept {
+			return capacity_limit;
+		}
+
+		// Применяет пакет вставок и удалений за один проход: операции сортируются по позиции (вставки в одну позицию
+		// сохраняют порядок), затем чанки от первой до последней затронутой позиции пересобираются слиянием,
+		// остальные остаются на месте. O(n + k log k) вместо O(k * n) у отдельных insert/erase.
+		// Пакет проверяется целиком до изменений; если бросит конструктор элемента, список останется корректным,
+		// но элементы затронутого участка могут оказаться перемещёнными
+		void apply_batch(std::vector<ChunkListOp<T>> ops) {
+			if (ops.empty())
+				return;
+
+			std::stable_sort(ops.begin(), ops.end(),
+				[](const ChunkListOp<T>& lhs, const ChunkListOp<T>& rhs) { return lhs.pos < rhs.pos; });
+			// Вставки в ту же позицию могут стоять между удалениями, поэтому помним последнюю удалённую позицию
+			bool erased_any = false;
+			std::size_t last_erased = 0;
+			for (const ChunkListOp<T>& op : ops) {
+				bool erase = op.kind == ChunkListOpKind::Erase;
+				std::size_t size = static_cast<std::size_t>(list_size);
+				if (op.pos > size || (erase && op.pos == size))
+					throw std::out_of_range("Index out of range");
+				if (!erase)
+					continue;
+				if (erased_any && last_erased == op.pos)
+					throw std::invalid_argument("Element is erased twice");
+				erased_any = true;
+				last_erased = op.pos;
+			}
+
+			if (first_chunk == nullptr)
+				first_chunk = tail_chunk = create_first_chunk();
+
+			// Пересобираемый участок: чанки от содержащего первую позицию до содержащего последнюю
+			int offset = 0;
+			Chunk<value_type, allocator_type>* start = locate(ops.front().pos, offset);
+			size_type index = ops.front().pos - offset;
+			Chunk<value_type, allocator_type>* stop = start;
+			for (size_type stop_end = index + start->num_of_elements; stop_end <= ops.back().pos && stop->next != nullptr;) {
+				stop = stop->next;
+				stop_end += stop->num_of_elements;
+			}
+
+			ChunkList rebuilt(allocator);
+			rebuilt.set_chunk_policy(get_chunk_policy());
+			auto op = ops.begin();
+			for (Chunk<value_type, allocator_type>* curr_chunk = start;; curr_chunk = curr_chunk->next) {
+				for (value_type* elem = curr_chunk->begin(); elem != curr_chunk->end(); ++elem, ++index) {
+					bool erased = false;
+					for (; op != ops.end() && op->pos == index; ++op) {
+						if (op->kind == ChunkListOpKind::Erase)
+							erased = true;
+						else
+							rebuilt.emplace_back(std::move(*op->value));
+					}
+					if (!erased)
+						rebuilt.emplace_back(std::move(*elem));
 				}
+				if (curr_chunk == stop)
+					break;
+			}
+			// Остались только вставки в конец
+			for (; op != ops.end(); ++op)
+				rebuilt.emplace_back(std::move(*op->value));
+
+			// Старые чанки участка освобождаются вместе с перемещёнными элементами, на их место встаёт rebuilt
+			Chunk<value_type, allocator_type>* before = start->prev;
+			Chunk<value_type, allocator_type>* after = stop->next;
+			for (Chunk<value_type, allocator_type>* curr_chunk = start; curr_chunk != after;) {
+				Chunk<value_type, allocator_type>* next = curr_chunk->next;
+				list_size -= curr_chunk->num_of_elements;
+				destroy_chunk(curr_chunk);
+				curr_chunk = next;
 			}
 
-			chunk_size = count;
+			Chunk<value_type, allocator_type>* head = after;
+			Chunk<value_type, allocator_type>* tail = before;
+			if (rebuilt.list_size > 0) {
+				rebuilt.evict_inline();
+				head = rebuilt.first_chunk;
+				tail = rebuilt.tail_chunk;
+				adopt_chain(rebuilt, head);
+				tail->next = after;
+				head->prev = before;
+			}
+			if (before != nullptr)
+				before->next = head;
+			else
+				first_chunk = head;
+			if (after != nullptr)
+				after->prev = tail;
+			else
+				tail_chunk = tail;
+		}
+
+		void resize(size_type count) {
+			resize(count, value_type());
 		};
 
 		void resize(size_type count, const value_type& value) {
-			if (count < 0)
-				throw std::invalid_argument("Count can not be negative");
+			if (count < list_size)
+				truncate(count);
+			else
+				insert_n(list_size, count - list_size, [this, &value](value_type* slot) { construct(slot, value); });
+		};
 
-			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
+		// Перецепляет чанки other в конец списка без копирования элементов, other остаётся пустым.
+		// Копируются только элементы встроенного чанка other. При разных аллокаторах элементы переносятся поштучно
+		void splice_back(ChunkList&& other) {
+			if (this == &other || other.list_size == 0)
+				return;
+			if (allocator != other.allocator) {
+				splice_back(ChunkList(std::move(other), allocator));
+				return;
+			}
 
-			while (curr_chunk != nullptr) {
-				curr_chunk->resize(count, value);
-				curr_chunk = curr_chunk->next;
+			other.evict_inline();
+			if (list_size == 0)
+				clear();
+			Chunk<value_type, allocator_type>* head = other.first_chunk;
+			Chunk<value_type, allocator_type>* tail = other.tail_chunk;
+			adopt_chain(other, head);
+			chain_link_after(first_chunk, tail_chunk, tail_chunk, head, tail);
+		}
+
+		// То же в начало списка. Встроенный чанк этого списка должен оставаться первым,
+		// поэтому его элементы переезжают в обычный чанк
+		void splice_front(ChunkList&& other) {
+			if (this == &other || other.list_size == 0)
+				return;
+			if (allocator != other.allocator) {
+				splice_front(ChunkList(std::move(other), allocator));
+				return;
+			}
+			if (list_size == 0) {
+				splice_back(std::move(other));
+				return;
 			}
 
-			if (count < N) {
-				list_size = 0;
+			other.evict_inline();
+			evict_inline();
+			Chunk<value_type, allocator_type>* head = other.first_chunk;
+			Chunk<value_type, allocator_type>* tail = other.tail_chunk;
+			adopt_chain(other, head);
+			chain_link_after<Chunk<value_type, allocator_type>>(first_chunk, tail_chunk, nullptr, head, tail);
+		}
 
-				curr_chunk = first_chunk;
-				while (curr_chunk != nullptr) {
-					list_size += curr_chunk->num_of_elements;
-					curr_chunk = curr_chunk->next;
-				}
+		// Отрезает элементы [pos, size()) в новый список с тем же аллокатором и политикой чанков.
+		// Чанки хвоста перецепляются; копируется только часть граничного чанка после pos
+		ChunkList split_at(size_type pos) {
+			if (pos > list_size)
+				throw std::out_of_range("Index out of range");
+
+			ChunkList result(allocator);
+			result.set_chunk_policy(get_chunk_policy());
+			if (pos == list_size)
+				return result;
+
+			Chunk<value_type, allocator_type>* start = nullptr;
+			if (pos == 0) {
+				evict_inline();
+				start = first_chunk;
+			}
+			else {
+				start = split_at_index(pos)->next;
 			}
+			result.first_chunk = start;
+			result.tail_chunk = tail_chunk;
+			result.adopt_chain(*this, start);
+			return result;
+		}
 
-			chunk_size = count;
-		};
+		void swap(ChunkList& other) noexcept(nothrow_steal) {
+			if constexpr (InlineN > 0) {
+				ChunkList tmp(allocator);
+				tmp.steal(other);
+				other.steal(*this);
+				steal(tmp);
+				if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+					std::swap(other.allocator, allocator);
+				return;
+			}
 
-		void swap(ChunkList<T, N, Allocator>& other) {
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value)
+				std::swap(other.allocator, allocator);
 			std::swap(other.first_chunk, first_chunk);
+			std::swap(other.tail_chunk, tail_chunk);
 			std::swap(other.list_size, list_size);
+			std::swap(other.chunk_count, chunk_count);
+			std::swap(other.total_capacity, total_capacity);
+			std::swap(other.chunk_size, chunk_size);
+			std::swap(other.max_chunk_size, max_chunk_size);
+			std::swap(other.auto_compact_threshold, auto_compact_threshold);
+			std::swap(other.auto_compact_fill, auto_compact_fill);
+			std::swap(other.capacity_limit, capacity_limit);
+			std::swap(other.spare_chunks, spare_chunks);
+			std::swap(other.spare_capacity, spare_capacity);
+			std::swap(other.slabs, slabs);
+			std::swap(other.allocated_bytes, allocated_bytes);
 		}
 
 		void print() {
 			int chunk_num = 1;
 			Chunk<value_type, allocator_type>* curr_chunk = first_chunk;
-			while (true) {
+			while (curr_chunk != nullptr) {
 				std::cout << "Chunk num: " << chunk_num << std::endl;
 				for (value_type* el = curr_chunk->begin(); el != curr_chunk->end(); el++)
 					std::cout << *el << "\t";
@@ -1193,8 +2094,8 @@ namespace fefu_laboratory_two {
 			}
 		}
 
-		friend bool operator==(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator==(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			if (lhs.list_size != rhs.list_size)
 				return false;
 
@@ -1205,13 +2106,13 @@ namespace fefu_laboratory_two {
 			return true;
 		};
 
-		friend bool operator!=(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator!=(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			return !operator==(lhs, rhs);
 		};
 
-		friend bool operator>(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator>(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			if (lhs.list_size != rhs.list_size) {
 				return lhs.list_size > rhs.list_size;
 			}
@@ -1224,13 +2125,13 @@ namespace fefu_laboratory_two {
 			}
 		};
 
-		friend bool operator<(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator<(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			return !operator>(lhs, rhs);
 		};
 
-		friend bool operator>=(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator>=(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			if (lhs.list_size < rhs.list_size) {
 				return false;
 			}
@@ -1243,8 +2144,8 @@ namespace fefu_laboratory_two {
 			}
 		};
 
-		friend bool operator<=(const ChunkList<value_type, N, allocator_type>& lhs,
-			const ChunkList<value_type, N, allocator_type>& rhs) {
+		friend bool operator<=(const ChunkList& lhs,
+			const ChunkList& rhs) {
 			return !operator>=(lhs, rhs);
 		};
 
@@ -1272,13 +2173,29 @@ namespace fefu_laboratory_two {
 		}
 	};
 
-	template <class T, int N, class Alloc>
-	void swap(ChunkList<T, N, Alloc>& lhs, ChunkList<T, N, Alloc>& rhs);
-
-	template <class T, int N, class Alloc, class U>
-	typename ChunkList<T, N, Alloc>::size_type erase(ChunkList<T, N, Alloc>& c, const U& value);
-
-	template <class T, int N, class Alloc, class Pred>
-	typename ChunkList<T, N, Alloc>::size_type erase_if(ChunkList<T, N, Alloc>& c, Pred pred);
+	template <class T, int N, class Alloc, int InlineN>
+	void swap(ChunkList<T, N, Alloc, InlineN>& lhs, ChunkList<T, N, Alloc, InlineN>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+		lhs.swap(rhs);
+	}
+
+	template <class T, int N, class Alloc, int InlineN, class U>
+	typename ChunkList<T, N, Alloc, InlineN>::size_type erase(ChunkList<T, N, Alloc, InlineN>& c, const U& value) {
+		return c.remove(value);
+	}
+
+	template <class T, int N, class Alloc, int InlineN, class Pred>
+	typename ChunkList<T, N, Alloc, InlineN>::size_type erase_if(ChunkList<T, N, Alloc, InlineN>& c, Pred pred) {
+		return c.remove_if(pred);
+	}
+
+	namespace pmr {
+		// Список поверх std::pmr::memory_resource: заголовки чанков и буферы берутся из ресурса,
+		// например из monotonic_buffer_resource, который освобождается целиком
+		template <typename T, int N = ChunkTraits<T>::chunk_size, int InlineN = 0>
+		using ChunkList = fefu_laboratory_two::ChunkList<T, N, std::pmr::polymorphic_allocator<T>, InlineN>;
+	}
 }
 
+// Упакованная специализация ChunkList<bool> (BoolChunkList.h, через PackedChunkList.h) подключается здесь,
+// чтобы ChunkList<bool> везде означал одно и то же
+#include "PackedChunkList.h"
@@ -0,0 +1,244 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+
+namespace fefu_laboratory_two {
+	// Статистика кэша текущего потока: hits — блоки, выданные из магазина, misses — обращения к operator new
+	struct ChunkCacheStats {
+		std::size_t hits = 0;
+		std::size_t misses = 0;
+	};
+
+	// Кэш свободных блоков чанков. У каждого потока свой магазин на каждый размер блока в байтах,
+	// поэтому в обычном случае выделение — это снятие указателя с вершины локального вектора без блокировок.
+	// Магазин обменивается с общим складом пачками по batch блоков под одним мьютексом
+	class ChunkCache {
+	public:
+		static constexpr std::size_t batch = 32;
+		// Блоки крупнее не кэшируются и сразу возвращаются системе
+		static constexpr std::size_t max_block_size = 256 * 1024;
+
+		static void* allocate(std::size_t bytes, std::size_t alignment) {
+			if (!cacheable(bytes, alignment))
+				return allocate_new(bytes, alignment);
+
+			ThreadCache* cache = thread_cache();
+			if (cache == nullptr)
+				return ::operator new(bytes);
+			std::vector<void*>& blocks = cache->magazine(bytes);
+			if (blocks.empty())
+				depot().take(bytes, blocks);
+			if (blocks.empty()) {
+				++cache->stats.misses;
+				return ::operator new(bytes);
+			}
+			++cache->stats.hits;
+			void* p = blocks.back();
+			blocks.pop_back();
+			return p;
+		}
+
+		static void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+			if (!cacheable(bytes, alignment)) {
+				deallocate_new(p, alignment);
+				return;
+			}
+
+			// Кэш потока уже уничтожен (список пережил свой поток или статический список разрушается при выходе)
+			// либо поток не выделял блоков такого размера: блок сразу возвращается системе, без выделений на пути освобождения
+			ThreadCache* cache = thread_cache();
+			std::vector<void*>* blocks = cache != nullptr ? cache->find_magazine(bytes) : nullptr;
+			if (blocks == nullptr) {
+				::operator delete(p);
+				return;
+			}
+			if (blocks->size() == 2 * batch)
+				depot().put(bytes, *blocks, batch);
+			// Ёмкость магазина зарезервирована на 2 * batch, push_back не выделяет
+			blocks->push_back(p);
+		}
+
+		static ChunkCacheStats stats() noexcept {
+			ThreadCache* cache = thread_cache();
+			return cache != nullptr ? cache->stats : ChunkCacheStats();
+		}
+
+	private:
+		static bool cacheable(std::size_t bytes, std::size_t alignment) noexcept {
+			return bytes <= max_block_size && alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+		}
+
+		static void* allocate_new(std::size_t bytes, std::size_t alignment) {
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+				return ::operator new(bytes, std::align_val_t(alignment));
+			return ::operator new(bytes);
+		}
+
+		static void deallocate_new(void* p, std::size_t alignment) noexcept {
+			if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+				::operator delete(p, std::align_val_t(alignment));
+			else
+				::operator delete(p);
+		}
+
+		struct Shelf {
+			std::size_t bytes;
+			std::vector<void*> blocks;
+		};
+
+		// Общий склад: свободные блоки всех потоков, сгруппированные по размеру
+		class Depot {
+		public:
+			Depot() noexcept {
+				depot_alive.store(true, std::memory_order_release);
+			}
+
+			~Depot() {
+				depot_alive.store(false, std::memory_order_release);
+				for (Shelf& shelf : shelves)
+					for (void* p : shelf.blocks)
+						::operator delete(p);
+			}
+
+			// Переносит до batch блоков размера bytes в пустой магазин to
+			void take(std::size_t bytes, std::vector<void*>& to) {
+				std::lock_guard<std::mutex> lock(mutex);
+				std::vector<void*>& from = shelf(bytes);
+				std::size_t count = std::min(batch, from.size());
+				to.insert(to.end(), from.end() - count, from.end());
+				from.resize(from.size() - count);
+			}
+
+			// Переносит count верхних блоков магазина from на склад
+			void put(std::size_t bytes, std::vector<void*>& from, std::size_t count) noexcept {
+				std::lock_guard<std::mutex> lock(mutex);
+				try {
+					std::vector<void*>& to = shelf(bytes);
+					to.insert(to.end(), from.end() - count, from.end());
+				}
+				catch (...) {
+					// Склад не смог вырасти: блоки возвращаются системе
+					for (auto it = from.end() - count; it != from.end(); ++it)
+						::operator delete(*it);
+				}
+				from.resize(from.size() - count);
+			}
+
+		private:
+			std::vector<void*>& shelf(std::size_t bytes) {
+				for (Shelf& shelf : shelves)
+					if (shelf.bytes == bytes)
+						return shelf.blocks;
+				shelves.push_back(Shelf{ bytes, {} });
+				return shelves.back().blocks;
+			}
+
+			std::mutex mutex;
+			std::vector<Shelf> shelves;
+		};
+
+		// Магазины одного потока. При завершении потока всё содержимое уходит на склад
+		struct ThreadCache {
+			std::vector<Shelf> shelves;
+			std::size_t last = 0;
+			ChunkCacheStats stats;
+
+			ThreadCache() noexcept {
+				depot();
+				cache_state = CacheState::alive;
+			}
+
+			~ThreadCache() {
+				cache_state = CacheState::destroyed;
+				// Поток может завершиться уже после разрушения склада при выходе из программы
+				bool to_depot = depot_alive.load(std::memory_order_acquire);
+				for (Shelf& shelf : shelves) {
+					if (to_depot) {
+						depot().put(shelf.bytes, shelf.blocks, shelf.blocks.size());
+					}
+					else {
+						for (void* p : shelf.blocks)
+							::operator delete(p);
+					}
+				}
+			}
+
+			std::vector<void*>* find_magazine(std::size_t bytes) noexcept {
+				if (last < shelves.size() && shelves[last].bytes == bytes)
+					return &shelves[last].blocks;
+				for (std::size_t i = 0; i < shelves.size(); ++i)
+					if (shelves[i].bytes == bytes)
+						return &shelves[last = i].blocks;
+				return nullptr;
+			}
+
+			// Новый магазин сразу получает ёмкость 2 * batch, чтобы deallocate не выделял память
+			std::vector<void*>& magazine(std::size_t bytes) {
+				if (std::vector<void*>* blocks = find_magazine(bytes))
+					return *blocks;
+				std::vector<void*> blocks;
+				blocks.reserve(2 * batch);
+				shelves.push_back(Shelf{ bytes, std::move(blocks) });
+				last = shelves.size() - 1;
+				return shelves.back().blocks;
+			}
+		};
+
+		// Жизнь кэша потока. Переменная без деструктора, поэтому её можно читать и после уничтожения ThreadCache
+		enum class CacheState : unsigned char {
+			unused,
+			alive,
+			destroyed
+		};
+		static inline thread_local CacheState cache_state = CacheState::unused;
+		static inline std::atomic<bool> depot_alive{ false };
+
+		// Склад создаётся раньше любого ThreadCache и поэтому уничтожается после них
+		static Depot& depot() noexcept {
+			static Depot instance;
+			return instance;
+		}
+
+		// nullptr, если кэш потока уже уничтожен
+		static ThreadCache* thread_cache() noexcept {
+			if (cache_state == CacheState::destroyed)
+				return nullptr;
+			thread_local ThreadCache cache;
+			return &cache;
+		}
+	};
+
+	// Аллокатор без состояния поверх ChunkCache: для ChunkList<T, N, CachingAllocator<T>> и заголовки чанков,
+	// и их буферы переиспользуются через магазины потока
+	template <typename T>
+	class CachingAllocator {
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		constexpr CachingAllocator() noexcept = default;
+
+		template <class U>
+		constexpr CachingAllocator(const CachingAllocator<U>&) noexcept {};
+
+		T* allocate(size_type N) {
+			return static_cast<T*>(ChunkCache::allocate(N * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_type N) noexcept {
+			ChunkCache::deallocate(p, N * sizeof(T), alignof(T));
+		}
+	};
+
+	template <class T, class U>
+	constexpr bool operator==(const CachingAllocator<T>&, const CachingAllocator<U>&) noexcept {
+		return true;
+	}
+}
@@ -1,11 +1,124 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include "Chunk.h"
+#include "ChunkCache.h"
+#include "HugePageArena.h"
+#include "NumaPolicy.h"
+#include "ChunkQueue.h"
+#include "ColumnarChunkList.h"
+#include "PackedChunkList.h"
 #include <vector>
+#include <string>
+#include <memory_resource>
+#include <thread>
+#include <climits>
 
 using namespace fefu_laboratory_two;
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
+namespace ChunkListUnitTest
+{
+	struct Record {
+		char payload[200];
+	};
+
+	// Больше 2 КиБ: в чанк по умолчанию помещается один элемент
+	struct Big {
+		int key;
+		char payload[3000];
+	};
+
+	// Считает живые экземпляры, чтобы проверять парность конструирования и уничтожения
+	struct Tracked {
+		static inline int alive = 0;
+		int value;
+
+		Tracked(int value = 0) : value(value) { ++alive; }
+		Tracked(const Tracked& other) : value(other.value) { ++alive; }
+		Tracked& operator=(const Tracked&) = default;
+		~Tracked() { --alive; }
+	};
+
+	// Считает копирования и перемещения, чтобы проверять, что emplace не создаёт временных объектов
+	struct Counted {
+		static inline int copies = 0;
+		int first;
+		int second;
+
+		Counted(int first, int second) : first(first), second(second) {}
+		Counted(const Counted& other) : first(other.first), second(other.second) { ++copies; }
+		Counted(Counted&& other) noexcept : first(other.first), second(other.second) { ++copies; }
+		Counted& operator=(const Counted&) = default;
+	};
+
+	// Ресурс памяти, который считает выданные и ещё не возвращённые байты
+	class CountingResource : public std::pmr::memory_resource {
+	public:
+		std::size_t allocated = 0;
+		std::size_t outstanding = 0;
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+			allocated += bytes;
+			outstanding += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+			outstanding -= bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+	};
+
+	// Аллокатор, который считает обращения к памяти. Счётчики общие для всех типов, поэтому
+	// один чанк — это два выделения: заголовок и буфер элементов
+	struct AllocationLog {
+		static inline int allocations = 0;
+		static inline int deallocations = 0;
+
+		static void reset() {
+			allocations = 0;
+			deallocations = 0;
+		}
+	};
+
+	template <typename T>
+	class CountingAllocator {
+	public:
+		using value_type = T;
+
+		CountingAllocator() noexcept = default;
+
+		template <class U>
+		CountingAllocator(const CountingAllocator<U>&) noexcept {};
+
+		T* allocate(std::size_t n) {
+			++AllocationLog::allocations;
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, std::size_t) noexcept {
+			++AllocationLog::deallocations;
+			::operator delete(p);
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const CountingAllocator<T>&, const CountingAllocator<U>&) noexcept {
+		return true;
+	}
+}
+
+namespace fefu_laboratory_two
+{
+	template <>
+	struct ChunkTraits<ChunkListUnitTest::Record> : ChunkBudget<ChunkListUnitTest::Record, 64 * 1024> {};
+}
+
 namespace ChunkListUnitTest
 {
 	TEST_CLASS(ConstructorTests)
@@ -222,6 +335,67 @@ namespace ChunkListUnitTest
 			Assert::IsTrue(list.size() == 9);
 			Assert::IsTrue(list.max_size() == 16);
 		}
+
+		TEST_METHOD(Stats) {
+			ChunkList<int, 8> list;
+			ChunkListStats empty = list.stats();
+			Assert::IsTrue(empty.chunk_count == 0);
+			Assert::IsTrue(empty.bytes_allocated == 0);
+			Assert::IsTrue(empty.allocations == 0);
+
+			for (int i = 0; i < 40; i++)
+				list.push_back(i);
+			for (int i = 0; i < 7; i++) {
+				list.erase(list.cbegin() + 8);
+				list.erase(list.cbegin() + 9);
+			}
+
+			ChunkListStats stats = list.stats();
+			Assert::IsTrue(stats.size == 26);
+			Assert::IsTrue(stats.chunk_count == 4);
+			Assert::IsTrue(stats.capacity == 32);
+			Assert::IsTrue(stats.fill_histogram[9] == 3);
+			Assert::IsTrue(stats.fill_histogram[2] == 1);
+			Assert::IsTrue(stats.longest_underfilled_run == 1);
+			Assert::IsTrue(stats.allocations == 10);
+			Assert::IsTrue(stats.deallocations == 2);
+			Assert::IsTrue(stats.bytes_allocated >= 40 * sizeof(int));
+			Assert::IsTrue(stats.fill_factor() == 26.0 / 32);
+
+			list.clear();
+			stats = list.stats();
+			Assert::IsTrue(stats.bytes_allocated == 0);
+			Assert::IsTrue(stats.deallocations == stats.allocations);
+		}
+
+		TEST_METHOD(Counters) {
+			ChunkList<int, 4> list;
+			for (int i = 0; i < 16; i++)
+				list.push_back(i);
+			list.reset_counters();
+
+			Assert::IsTrue(list.at(13) == 13);
+			list.insert(list.cbegin() + 1, -1);
+			ChunkListCounters counters = list.counters();
+			if constexpr (ChunkList<int, 4>::counters_enabled) {
+				Assert::IsTrue(counters.chunk_hops >= 3);
+				Assert::IsTrue(counters.element_moves == 3);
+				// Новый чанк — заголовок и буфер, как и в stats()
+				Assert::IsTrue(counters.allocations == 2);
+
+				ChunkList<int, 4> fresh;
+				fresh.reserve(10);
+				for (int i = 0; i < 20; i++)
+					fresh.push_back(i);
+				fresh.shrink_to_fit();
+				Assert::IsTrue(fresh.counters().allocations == fresh.stats().allocations);
+			}
+			else {
+				Assert::IsTrue(counters.chunk_hops == 0);
+				Assert::IsTrue(counters.element_moves == 0);
+				Assert::IsTrue(counters.allocations == 0);
+			}
+		}
 	};
 
 	TEST_CLASS(MODIFIERSTests) {
@@ -251,6 +425,24 @@ namespace ChunkListUnitTest
 			Assert::IsTrue(list == list2);
 		}
 
+		TEST_METHOD(InsertIntoSingleSlotChunks) {
+			ChunkList<int, 1> list;
+			list.push_back(2);
+			list.push_front(0);
+			list.insert(list.cbegin() + 1, 1);
+			list.push_back(3);
+			list.insert(list.cbegin() + 2, 5);
+			Assert::IsTrue(list.size() == 5);
+			Assert::IsTrue(list[0] == 0 && list[1] == 1 && list[2] == 5 && list[3] == 2 && list[4] == 3);
+
+			static_assert(ChunkTraits<Big>::chunk_size == 1);
+			ChunkList<Big> big;
+			big.push_back(Big{ 1 });
+			big.push_front(Big{ 0 });
+			big.insert(big.cbegin() + 1, Big{ 2 });
+			Assert::IsTrue(big[0].key == 0 && big[1].key == 2 && big[2].key == 1);
+		}
+
 		TEST_METHOD(Erase) {
 			ChunkList<int, 8> list;
 			ChunkList<int, 8> list2;
@@ -267,6 +459,45 @@ namespace ChunkListUnitTest
 			Assert::IsTrue(list == list2);
 		}
 
+		TEST_METHOD(EraseRange) {
+			ChunkList<int, 4> list;
+			ChunkList<int, 4> list2 = { 0, 1, 7, 8, 9 };
+
+			for (int i = 0; i < 10; i++)
+				list.push_back(i);
+
+			list.erase(list.cbegin() + 2, list.cbegin() + 7);
+
+			Assert::IsTrue(list == list2);
+			Assert::IsTrue(list.max_size() == 8);
+		}
+
+		TEST_METHOD(EraseIf) {
+			ChunkList<int, 4> list;
+			ChunkList<int, 4> list2;
+
+			for (int i = 0; i < 20; i++) {
+				list.push_back(i);
+				if (i % 3 == 0)
+					list2.push_back(i);
+			}
+
+			auto removed = erase_if(list, [](int x) { return x % 3 != 0; });
+			Assert::IsTrue(removed == 13);
+			Assert::IsTrue(list == list2);
+			Assert::IsTrue(list.back() == 18);
+
+			removed = erase(list, 9);
+			Assert::IsTrue(removed == 1);
+			Assert::IsTrue(list.size() == 6);
+			Assert::IsTrue(list[3] == 12);
+
+			erase_if(list, [](int) { return true; });
+			Assert::IsTrue(list.empty());
+			list.push_back(5);
+			Assert::IsTrue(list.front() == 5);
+		}
+
 		TEST_METHOD(PushAndPop) {
 			ChunkList<int, 8> list;
 
@@ -298,6 +529,55 @@ namespace ChunkListUnitTest
 			Assert::IsTrue(list[0] == 22);
 			Assert::IsTrue(list[9] == 10);
 		}
+
+		TEST_METHOD(EmplaceInPlace) {
+			ChunkList<Counted, 4> list;
+			Counted::copies = 0;
+			for (int i = 0; i < 10; i++) {
+				Counted& elem = list.emplace_back(i, -i);
+				Assert::IsTrue(elem.second == -i);
+			}
+			Assert::IsTrue(Counted::copies == 0);
+
+			Counted& front = list.emplace_front(100, 200);
+			Assert::IsTrue(front.first == 100);
+			auto it = list.emplace(list.cbegin() + 5, 50, 60);
+			Assert::IsTrue(it->second == 60);
+			Assert::IsTrue(list[5].first == 50);
+			Assert::IsTrue(list.size() == 12);
+			Assert::IsTrue(list.back().first == 9);
+		}
+
+		TEST_METHOD(LazyConstruction) {
+			{
+				ChunkList<Tracked, 8> list;
+				list.reserve(64);
+				Assert::IsTrue(Tracked::alive == 0);
+
+				for (int i = 0; i < 20; i++)
+					list.push_back(Tracked(i));
+				Assert::IsTrue(Tracked::alive == 20);
+
+				list.insert(list.cbegin() + 3, Tracked(-1));
+				list.erase(list.cbegin() + 10);
+				list.pop_back();
+				list.remove_if([](const Tracked& elem) { return elem.value % 3 == 0; });
+				Assert::IsTrue(Tracked::alive == static_cast<int>(list.size()));
+
+				list.resize(30, Tracked(7));
+				list.shrink_to_fit();
+				Assert::IsTrue(Tracked::alive == 30);
+				Assert::IsTrue(list.back().value == 7);
+			}
+			Assert::IsTrue(Tracked::alive == 0);
+
+			ChunkList<std::string, 4> strings(6, "chunk");
+			strings.insert(strings.cbegin() + 2, "list");
+			strings.erase(strings.cbegin());
+			Assert::IsTrue(strings.size() == 6);
+			Assert::IsTrue(strings[1] == "list");
+			Assert::IsTrue(strings.back() == "chunk");
+		}
 	};
 
 	TEST_CLASS(RestructureTests) {
@@ -316,6 +596,1006 @@ namespace ChunkListUnitTest
 
 			Assert::IsTrue(list == list2);
 		}
+
+		TEST_METHOD(DefaultChunkSize) {
+			static_assert(ChunkTraits<int>::chunk_size == 1024);
+			static_assert(ChunkTraits<double>::chunk_size == 512);
+			static_assert(ChunkBudget<Record, 4096>::chunk_size == 20);
+			static_assert(ChunkTraits<Record>::chunk_size == 327);
+
+			ChunkList<int> list;
+			for (int i = 0; i < 3000; i++)
+				list.push_back(i);
+			Assert::IsTrue(list.get_chunk_policy().initial_size == 1024);
+			Assert::IsTrue(list.max_size() == 3072);
+			Assert::IsTrue(list[2999] == 2999);
+
+			ChunkList<Record> records;
+			Assert::IsTrue(records.get_chunk_policy().initial_size == 327);
+		}
+
+		TEST_METHOD(RuntimeChunkSize) {
+			ChunkList<int, 8> list(ChunkPolicy{ 10 });
+			for (int i = 0; i < 40; i++)
+				list.push_back(i);
+
+			// Ёмкость не округляется до степени двойки
+			Assert::IsTrue(list.get_chunk_policy().initial_size == 10);
+			Assert::IsTrue(list.stats().capacity == 40);
+			Assert::IsTrue(list.max_size() == 40);
+			Assert::IsTrue(list[17] == 17);
+
+			list.resize(20);
+			Assert::IsTrue(list.size() == 20);
+			Assert::IsTrue(list.back() == 19);
+			list.resize(25, -1);
+			Assert::IsTrue(list.size() == 25);
+			Assert::IsTrue(list[19] == 19);
+			Assert::IsTrue(list[24] == -1);
+
+			Assert::ExpectException<std::invalid_argument>([&] { list.set_chunk_policy(ChunkPolicy{ INT_MAX }); });
+			Assert::ExpectException<std::invalid_argument>([&] { list.set_chunk_policy(ChunkPolicy{ 8, max_chunk_capacity + 1 }); });
+			Assert::IsTrue(list.get_chunk_policy().initial_size == 10);
+		}
+
+		TEST_METHOD(GeometricChunkSize) {
+			ChunkList<int, 4> grown(ChunkPolicy{ 3, 20 });
+			for (int i = 0; i < 50; i++)
+				grown.push_back(i);
+			std::vector<int> capacities;
+			for (auto* chunk = grown.last_chunk(); chunk != nullptr; chunk = chunk->prev)
+				capacities.insert(capacities.begin(), chunk->chunk_size);
+			Assert::IsTrue(capacities == std::vector<int>({ 3, 6, 12, 20, 20 }));
+
+			ChunkList<int, 4> list(ChunkPolicy{ 4, 64 });
+			std::vector<int> v;
+			for (int i = 0; i < 1000; i++) {
+				list.push_back(i);
+				v.push_back(i);
+			}
+
+			list.insert(list.cbegin() + 500, 3, -1);
+			v.insert(v.begin() + 500, 3, -1);
+			list.erase(list.cbegin() + 10);
+			v.erase(v.begin() + 10);
+			list.insert(list.cbegin() + 2, { 7, 8 });
+			v.insert(v.begin() + 2, { 7, 8 });
+
+			Assert::IsTrue(list.size() == v.size());
+			for (size_t i = 0; i < v.size(); i++)
+				Assert::IsTrue(list[i] == v[i]);
+		}
+
+		TEST_METHOD(Compact) {
+			ChunkList<int, 4> list;
+			ChunkList<int, 4> list2;
+
+			for (int i = 0; i < 40; i++)
+				list.push_back(i);
+
+			for (int i = 0; i < 40; i += 4) {
+				list.erase(list.cbegin() + i / 2 + 1);
+				list.erase(list.cbegin() + i / 2 + 1);
+			}
+			for (int i = 0; i < 40; i++)
+				if (i % 4 == 0 || i % 4 == 3)
+					list2.push_back(i);
+
+			Assert::IsTrue(list == list2);
+			list.compact(0.5);
+			Assert::IsTrue(list == list2);
+			list.compact();
+			Assert::IsTrue(list == list2);
+			list.insert(list.cbegin() + 5, 100);
+			Assert::IsTrue(list[5] == 100);
+			Assert::IsTrue(list[6] == list2[5]);
+			Assert::ExpectException<std::invalid_argument>([]() {
+				ChunkList<int, 4> l;
+				l.compact(0);
+				});
+		}
+
+		TEST_METHOD(AutoCompact) {
+			ChunkList<int, 8> list;
+			list.set_auto_compact(0.5);
+
+			for (int i = 0; i < 64; i++)
+				list.push_back(i);
+			for (int i = 0; i < 48; i++)
+				list.erase(list.cbegin() + (i * 7) % list.size());
+
+			Assert::IsTrue(list.size() == 16);
+			int prev = -1;
+			for (auto e : list) {
+				Assert::IsTrue(e > prev);
+				prev = e;
+			}
+		}
+
+		TEST_METHOD(ShrinkToFit) {
+			ChunkList<int, 8> list;
+			for (int i = 0; i < 20; i++)
+				list.push_back(i);
+			for (int i = 0; i < 6; i++)
+				list.erase(list.cbegin() + 3);
+
+			list.shrink_to_fit();
+			Assert::IsTrue(list.size() == 14);
+			Assert::IsTrue(list[2] == 2);
+			Assert::IsTrue(list[3] == 9);
+			Assert::IsTrue(list.back() == 19);
+
+			list.push_back(20);
+			Assert::IsTrue(list.back() == 20);
+			Assert::IsTrue(list.size() == 15);
+		}
+
+		TEST_METHOD(ShrinkReserved) {
+			ChunkList<int, 8> list;
+			list.reserve(10000);
+			for (int i = 0; i < 10; i++)
+				list.push_back(i);
+
+			list.shrink_to_fit();
+			Assert::IsTrue(list.capacity() == 10);
+			ChunkListStats stats = list.stats();
+			Assert::IsTrue(stats.spare_capacity == 0);
+			Assert::IsTrue(stats.bytes_allocated < 1024);
+			Assert::IsTrue(stats.allocations == stats.deallocations + stats.chunk_count * 2);
+			Assert::IsTrue(list[0] == 0 && list.back() == 9);
+
+			// Блок, часть чанков которого живёт в другом списке
+			ChunkList<int, 8> other;
+			other.reserve(64);
+			for (int i = 0; i < 64; i++)
+				other.push_back(i);
+			ChunkList<int, 8> tail = other.split_at(32);
+			other.shrink_to_fit();
+			Assert::IsTrue(other.capacity() == 32 && other[31] == 31);
+			tail.shrink_to_fit();
+			Assert::IsTrue(tail.capacity() == 32 && tail[0] == 32);
+		}
+
+		TEST_METHOD(Reserve) {
+			ChunkList<int, 8> list;
+			list.reserve(100);
+			Assert::IsTrue(list.size() == 0);
+			Assert::IsTrue(list.capacity() == 104);
+
+			for (int i = 0; i < 100; i++)
+				list.push_back(i);
+			Assert::IsTrue(list.capacity() == 104);
+			Assert::IsTrue(list[50] == 50);
+			Assert::IsTrue(list.back() == 99);
+
+			list.erase(list.cbegin(), list.cbegin() + 40);
+			list.reserve(70);
+			Assert::IsTrue(list.capacity() == 104);
+			Assert::IsTrue(list.front() == 40);
+
+			ChunkList<int, 4> list2(10, 7);
+			Assert::IsTrue(list2.size() == 10);
+			Assert::IsTrue(list2.capacity() == 12);
+			Assert::IsTrue(list2[9] == 7);
+
+			ChunkList<int, 4> list3(5);
+			Assert::IsTrue(list3.size() == 5);
+			Assert::IsTrue(list3[4] == 0);
+		}
+	};
+
+	TEST_CLASS(SmallListTests) {
+		TEST_METHOD(InlineChunk) {
+			ChunkList<int, 8, Allocator<int>, 4> list;
+			ChunkList<int, 8, Allocator<int>, 4> list2 = { 0, 1, 2 };
+			Assert::IsTrue(list.empty());
+			Assert::IsTrue(list.begin() == list.end());
+
+			for (int i = 0; i < 3; i++)
+				list.push_back(i);
+			Assert::IsTrue(list == list2);
+
+			for (int i = 3; i < 20; i++)
+				list.push_back(i);
+			list.insert(list.cbegin(), -1);
+			list.erase(list.cbegin() + 5);
+			Assert::IsTrue(list.size() == 20);
+			Assert::IsTrue(list[0] == -1);
+			Assert::IsTrue(list[5] == 5);
+			Assert::IsTrue(list.back() == 19);
+
+			auto copy = list;
+			Assert::IsTrue(copy == list);
+
+			list.swap(list2);
+			Assert::IsTrue(list.size() == 3);
+			Assert::IsTrue(list2 == copy);
+
+			for (int i = 0; i < 4; i++)
+				list2.erase(list2.cbegin());
+			Assert::IsTrue(list2.front() == 3);
+			list2.clear();
+			list2.push_back(42);
+			Assert::IsTrue(list2.front() == 42);
+		}
+	};
+
+	TEST_CLASS(AllocatorTests) {
+		TEST_METHOD(MemoryResource) {
+			CountingResource resource;
+			{
+				pmr::ChunkList<std::pmr::string, 4> list(&resource);
+				for (int i = 0; i < 10; i++)
+					list.emplace_back(40, 'a' + i);
+				list.erase(list.cbegin() + 2);
+				Assert::IsTrue(list.get_allocator().resource() == &resource);
+				Assert::IsTrue(list[2].get_allocator().resource() == &resource);
+				Assert::IsTrue(resource.outstanding > 0);
+
+				pmr::ChunkList<std::pmr::string, 4> copy(list, &resource);
+				pmr::ChunkList<std::pmr::string, 4> moved(std::move(copy), &resource);
+				Assert::IsTrue(moved == list);
+				Assert::IsTrue(copy.empty());
+			}
+			Assert::IsTrue(resource.allocated > 0);
+			Assert::IsTrue(resource.outstanding == 0);
+
+			unsigned char buffer[4096];
+			std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+			pmr::ChunkList<int, 16> list(&arena);
+			for (int i = 0; i < 100; i++)
+				list.push_back(i);
+			Assert::IsTrue(list.size() == 100);
+			Assert::IsTrue(list.back() == 99);
+		}
+	};
+
+	TEST_CLASS(AllocationCountTests) {
+		TEST_METHOD(ExactCounts) {
+			using List = ChunkList<int, 8, CountingAllocator<int>>;
+			List list;
+			list.push_back(0);
+
+			AllocationLog::reset();
+			for (int i = 1; i < 8; i++)
+				list.push_back(i);
+			Assert::IsTrue(AllocationLog::allocations == 0);
+
+			// Новый чанк — заголовок и буфер
+			list.push_back(8);
+			Assert::IsTrue(AllocationLog::allocations == 2);
+			for (int i = 9; i < 24; i++)
+				list.push_back(i);
+			Assert::IsTrue(AllocationLog::allocations == 4);
+
+			AllocationLog::reset();
+			List moved(std::move(list));
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(AllocationLog::deallocations == 0);
+			Assert::IsTrue(moved.size() == 24);
+			Assert::IsTrue(moved.back() == 23);
+			Assert::IsTrue(list.empty());
+
+			List other;
+			other.push_back(100);
+			AllocationLog::reset();
+			moved.swap(other);
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(AllocationLog::deallocations == 0);
+			Assert::IsTrue(other.size() == 24);
+			Assert::IsTrue(moved.front() == 100);
+
+			// Копирующее присваивание: старые чанки освобождаются, копия ложится в один блок reserve()
+			AllocationLog::reset();
+			moved = other;
+			Assert::IsTrue(AllocationLog::allocations == 1);
+			Assert::IsTrue(AllocationLog::deallocations == 2);
+			Assert::IsTrue(moved == other);
+
+			list.push_back(1);
+			Assert::IsTrue(list.size() == 1);
+		}
+	};
+
+	TEST_CLASS(MoveTests) {
+		TEST_METHOD(NoexceptMoves) {
+			using List = ChunkList<int, 8, CountingAllocator<int>>;
+			static_assert(std::is_nothrow_move_constructible_v<List>);
+			static_assert(std::is_nothrow_move_assignable_v<List>);
+			static_assert(std::is_nothrow_swappable_v<List>);
+			static_assert(std::is_nothrow_move_constructible_v<ChunkList<int, 8, Allocator<int>, 4>>);
+
+			List source;
+			List target;
+			for (int i = 0; i < 20; i++) {
+				source.push_back(i);
+				target.push_back(-i);
+			}
+
+			// Старые чанки target освобождаются, чанки source перецепляются
+			AllocationLog::reset();
+			target = std::move(source);
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(AllocationLog::deallocations == 6);
+			Assert::IsTrue(target.size() == 20);
+			Assert::IsTrue(target[19] == 19);
+			Assert::IsTrue(source.empty());
+
+			swap(source, target);
+			Assert::IsTrue(source.size() == 20);
+			Assert::IsTrue(target.empty());
+
+			// Перевыделение вектора перемещает списки, а не копирует их
+			std::vector<List> shards(1);
+			shards[0].push_back(7);
+			AllocationLog::reset();
+			for (int i = 0; i < 16; i++)
+				shards.emplace_back();
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(shards[0].front() == 7);
+
+			ChunkList<int, 8, Allocator<int>, 4> small;
+			ChunkList<int, 8, Allocator<int>, 4> other;
+			for (int i = 0; i < 6; i++)
+				small.push_back(i);
+			other = std::move(small);
+			Assert::IsTrue(other.size() == 6);
+			Assert::IsTrue(other[5] == 5);
+			Assert::IsTrue(small.empty());
+			small.push_back(1);
+			Assert::IsTrue(small.front() == 1);
+		}
+	};
+
+	TEST_CLASS(SpliceTests) {
+		TEST_METHOD(SpliceAndSplit) {
+			using List = ChunkList<int, 8, CountingAllocator<int>>;
+			List list;
+			List back;
+			List front;
+			for (int i = 0; i < 20; i++)
+				list.push_back(i);
+			for (int i = 20; i < 40; i++)
+				back.push_back(i);
+			for (int i = -5; i < 0; i++)
+				front.push_back(i);
+
+			AllocationLog::reset();
+			list.splice_back(std::move(back));
+			list.splice_front(std::move(front));
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(back.empty());
+			Assert::IsTrue(front.empty());
+			Assert::IsTrue(list.size() == 45);
+			for (int i = 0; i < 45; i++)
+				Assert::IsTrue(list[i] == i - 5);
+
+			// Копируется только хвост граничного чанка
+			List tail = list.split_at(12);
+			Assert::IsTrue(AllocationLog::allocations <= 2);
+			Assert::IsTrue(list.size() == 12);
+			Assert::IsTrue(tail.size() == 33);
+			Assert::IsTrue(list.back() == 6);
+			Assert::IsTrue(tail.front() == 7);
+			Assert::IsTrue(tail.back() == 39);
+			list.push_back(100);
+			tail.push_front(-100);
+			Assert::IsTrue(list.size() == 13);
+			Assert::IsTrue(tail[1] == 7);
+
+			List all = tail.split_at(0);
+			Assert::IsTrue(tail.empty());
+			Assert::IsTrue(all.size() == 34);
+			Assert::ExpectException<std::out_of_range>([&]() { all.split_at(35); });
+
+			// Чанки из блока reserve() переживают список, который их зарезервировал
+			ChunkList<Tracked, 8> moved;
+			{
+				ChunkList<Tracked, 8> reserved(20, Tracked(1));
+				moved = reserved.split_at(5);
+				moved.splice_front(reserved.split_at(2));
+			}
+			Assert::IsTrue(moved.size() == 18);
+			moved.clear();
+			Assert::IsTrue(Tracked::alive == 0);
+
+			ChunkList<int, 8, Allocator<int>, 4> small{ 1, 2, 3 };
+			small.splice_back(ChunkList<int, 8, Allocator<int>, 4>{ 4, 5 });
+			small.splice_front(ChunkList<int, 8, Allocator<int>, 4>{ 0 });
+			Assert::IsTrue(small.size() == 6);
+			for (int i = 0; i < 6; i++)
+				Assert::IsTrue(small[i] == i);
+
+			// Разные ресурсы памяти: элементы переносятся поштучно
+			CountingResource first;
+			CountingResource second;
+			pmr::ChunkList<int, 4> left(&first);
+			pmr::ChunkList<int, 4> right(&second);
+			for (int i = 0; i < 6; i++) {
+				left.push_back(i);
+				right.push_back(i + 6);
+			}
+			left.splice_back(std::move(right));
+			Assert::IsTrue(left.size() == 12);
+			Assert::IsTrue(left[11] == 11);
+			Assert::IsTrue(second.outstanding == 0);
+		}
+	};
+
+	TEST_CLASS(RetentionTests) {
+		TEST_METHOD(DropAndTruncate) {
+			ChunkList<Tracked, 8> list;
+			for (int i = 0; i < 50; i++)
+				list.push_back(i);
+
+			list.drop_front(21);
+			Assert::IsTrue(list.size() == 29);
+			Assert::IsTrue(list.front().value == 21);
+			Assert::IsTrue(list[28].value == 49);
+			list.truncate_back(10);
+			Assert::IsTrue(list.size() == 19);
+			Assert::IsTrue(list.back().value == 39);
+			Assert::IsTrue(Tracked::alive == 19);
+			list.push_back(100);
+			Assert::IsTrue(list.back().value == 100);
+
+			list.drop_front(100);
+			Assert::IsTrue(list.empty());
+			Assert::IsTrue(Tracked::alive == 0);
+			list.push_back(1);
+			list.truncate_back(5);
+			Assert::IsTrue(list.empty());
+		}
+
+		TEST_METHOD(DropAtChunkBoundary) {
+			ChunkList<std::string, 4> list;
+			for (int i = 0; i < 8; i++)
+				list.push_back(std::string(40, static_cast<char>('a' + i)));
+
+			list.drop_front(0);
+			Assert::IsTrue(list.size() == 8);
+			Assert::IsTrue(list.front() == std::string(40, 'a'));
+			list.drop_front(4);
+			Assert::IsTrue(list.size() == 4);
+			Assert::IsTrue(list.front() == std::string(40, 'e'));
+			Assert::IsTrue(list.back() == std::string(40, 'h'));
+		}
+
+		TEST_METHOD(BoundedMode) {
+			using List = ChunkList<int, 8, CountingAllocator<int>>;
+			List list;
+			list.set_capacity_limit(32);
+			for (int i = 0; i < 32; i++)
+				list.push_back(i);
+
+			// Дальше чанки только переиспользуются
+			AllocationLog::reset();
+			for (int i = 32; i < 1000; i++)
+				list.push_back(i);
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(list.capacity() <= 32);
+			Assert::IsTrue(list.size() > 24);
+			Assert::IsTrue(list.back() == 999);
+			Assert::IsTrue(list.front() == 1000 - static_cast<int>(list.size()));
+
+			list.set_capacity_limit(16);
+			Assert::IsTrue(list.capacity() <= 16);
+			Assert::IsTrue(list.back() == 999);
+		}
+	};
+
+	TEST_CLASS(BatchTests) {
+		TEST_METHOD(ApplyBatch) {
+			using Op = ChunkListOp<int>;
+			ChunkList<int, 8> list;
+			std::vector<int> expected;
+			for (int i = 0; i < 100; i++) {
+				list.push_back(i);
+				expected.push_back(i);
+			}
+
+			// Позиции относятся к исходному списку: две вставки перед 10, удаление 10, вставка в конец
+			list.apply_batch({ Op::insert(10, -1), Op::erase(10), Op::insert(100, -3), Op::insert(10, -2), Op::erase(99) });
+			expected.erase(expected.begin() + 99);
+			expected.push_back(-3);
+			expected.erase(expected.begin() + 10);
+			expected.insert(expected.begin() + 10, { -1, -2 });
+			Assert::IsTrue(list.size() == expected.size());
+			for (std::size_t i = 0; i < expected.size(); i++)
+				Assert::IsTrue(list[i] == expected[i]);
+
+			unsigned state = 7;
+			for (int round = 0; round < 20; round++) {
+				std::vector<Op> ops;
+				std::vector<bool> erased(expected.size());
+				std::vector<std::vector<int>> inserted(expected.size() + 1);
+				for (int k = 0; k < 30; k++) {
+					state = state * 1103515245 + 12345;
+					std::size_t pos = (state >> 8) % (expected.size() + 1);
+					if (k % 3 == 0 && pos < expected.size() && !erased[pos]) {
+						erased[pos] = true;
+						ops.push_back(Op::erase(pos));
+					}
+					else {
+						inserted[pos].push_back(round * 100 + k);
+						ops.push_back(Op::insert(pos, round * 100 + k));
+					}
+				}
+				list.apply_batch(std::move(ops));
+
+				std::vector<int> next;
+				for (std::size_t i = 0; i <= expected.size(); i++) {
+					next.insert(next.end(), inserted[i].begin(), inserted[i].end());
+					if (i < expected.size() && !erased[i])
+						next.push_back(expected[i]);
+				}
+				expected = std::move(next);
+				Assert::IsTrue(list.size() == expected.size());
+				std::size_t i = 0;
+				for (int value : list)
+					Assert::IsTrue(value == expected[i++]);
+			}
+
+			Assert::ExpectException<std::out_of_range>([&] { list.apply_batch({ Op::erase(list.size()) }); });
+			Assert::ExpectException<std::invalid_argument>([&] { list.apply_batch({ Op::erase(3), Op::erase(3) }); });
+			Assert::ExpectException<std::invalid_argument>([&] { list.apply_batch({ Op::erase(3), Op::insert(3, 1), Op::erase(3) }); });
+			Assert::IsTrue(list.size() == expected.size());
+		}
+
+		TEST_METHOD(ApplyBatchWithoutDefaultConstructor) {
+			struct Keyed {
+				int key;
+				explicit Keyed(int key) : key(key) {}
+			};
+			ChunkList<Keyed, 4> list;
+			for (int i = 0; i < 10; i++)
+				list.emplace_back(i);
+
+			list.apply_batch({ ChunkListOp<Keyed>::erase(0), ChunkListOp<Keyed>::insert(5, Keyed(-1)) });
+			Assert::IsTrue(list.size() == 10);
+			Assert::IsTrue(list[0].key == 1 && list[4].key == -1 && list[5].key == 5);
+		}
+
+		TEST_METHOD(ApplyBatchWholeList) {
+			using Op = ChunkListOp<Tracked>;
+			ChunkList<Tracked, 4, Allocator<Tracked>, 4> list;
+			list.apply_batch({ Op::insert(0, 1), Op::insert(0, 2) });
+			Assert::IsTrue(list.size() == 2);
+			Assert::IsTrue(list[0].value == 1 && list[1].value == 2);
+
+			for (int i = 3; i < 20; i++)
+				list.push_back(i);
+			std::vector<Op> ops;
+			for (std::size_t i = 0; i < list.size(); i++)
+				ops.push_back(Op::erase(i));
+			list.apply_batch(std::move(ops));
+			Assert::IsTrue(list.empty());
+			Assert::IsTrue(Tracked::alive == 0);
+			list.push_front(5);
+			list.push_back(6);
+			Assert::IsTrue(list.front().value == 5 && list.back().value == 6);
+		}
+	};
+
+	TEST_CLASS(ColumnarTests) {
+		TEST_METHOD(RowsAndColumns) {
+			BasicColumnarChunkList<8, Allocator<unsigned char>, long long, int, double> list;
+			for (int i = 0; i < 50; i++)
+				list.emplace_back(1000LL + i, i, i * 0.5);
+			Assert::IsTrue(list.size() == 50);
+			Assert::IsTrue(list.chunk_count() == 7);
+
+			// Ссылка на строку пишет прямо в столбцы
+			auto [time, id, value] = list[10];
+			Assert::IsTrue(time == 1010 && id == 10 && value == 5.0);
+			id = -10;
+			Assert::IsTrue(list.at(10).get<1>() == -10);
+			list[11] = std::tuple<long long, int, double>(0, 0, 0.0);
+			Assert::IsTrue(list[11] == std::tuple<long long, int, double>(0, 0, 0.0));
+			list[12] = list[13];
+			Assert::IsTrue(list[12].get<0>() == 1013);
+
+			long long sum = 0;
+			std::size_t seen = 0;
+			list.for_each_span<0>([&](std::span<long long> column) {
+				for (long long t : column)
+					sum += t;
+				seen += column.size();
+			});
+			Assert::IsTrue(seen == 50);
+			Assert::IsTrue(sum == 50 * 1000 + 49 * 50 / 2 - 1011 + 1);
+
+			list.emplace(0, -1LL, -1, -1.0);
+			list.emplace(25, -2LL, -2, -2.0);
+			list.erase(50);
+			Assert::IsTrue(list.size() == 51);
+			Assert::IsTrue(list[0].get<0>() == -1 && list[1].get<0>() == 1000);
+			Assert::IsTrue(list[25].get<1>() == -2 && list[26].get<1>() == 24);
+			Assert::IsTrue(list.back().get<1>() == 49);
+			const auto& view = list;
+			Assert::IsTrue(view.front().get<0>() == -1 && view.back().get<1>() == 49);
+
+			std::size_t rows = 0;
+			long long ids = 0;
+			for (auto row : list) {
+				ids += row.get<1>();
+				rows++;
+			}
+			list.for_each_span<1>([&](std::span<int> column) {
+				for (int current : column)
+					ids -= current;
+			});
+			Assert::IsTrue(rows == 51 && ids == 0);
+			Assert::ExpectException<std::out_of_range>([&] { list.at(51); });
+			Assert::ExpectException<std::out_of_range>([&] { list.erase(51); });
+		}
+
+		TEST_METHOD(OwnershipAndCopies) {
+			{
+				ColumnarChunkList<int, Tracked> list;
+				for (int i = 0; i < 1000; i++)
+					list.emplace_back(i, Tracked(i));
+				Assert::IsTrue(Tracked::alive == 1000);
+				for (int i = 0; i < 500; i++)
+					list.erase(list.size() / 2);
+				list.pop_back();
+				Assert::IsTrue(Tracked::alive == 499);
+
+				ColumnarChunkList<int, Tracked> copy = list;
+				Assert::IsTrue(Tracked::alive == 998);
+				Assert::IsTrue(copy.size() == 499);
+				Assert::IsTrue(copy[300].get<1>().value == list[300].get<0>());
+
+				ColumnarChunkList<int, Tracked> moved = std::move(copy);
+				Assert::IsTrue(copy.empty());
+				Assert::IsTrue(moved.size() == 499);
+				copy = moved;
+				moved.clear();
+				Assert::IsTrue(Tracked::alive == 998);
+				swap(copy, moved);
+				Assert::IsTrue(copy.empty() && moved.size() == 499);
+			}
+			Assert::IsTrue(Tracked::alive == 0);
+		}
+
+		TEST_METHOD(SingleRowChunks) {
+			Assert::IsTrue(ColumnarChunkList<Big>::chunk_size == 1);
+			BasicColumnarChunkList<1, Allocator<unsigned char>, int, Tracked> list;
+			list.emplace_back(1, Tracked(1));
+			list.emplace(0, 0, Tracked(0));
+			list.emplace(1, 5, Tracked(5));
+			list.emplace(3, 9, Tracked(9));
+			Assert::IsTrue(list.size() == 4 && list.chunk_count() == 4);
+			int expected[] = { 0, 5, 1, 9 };
+			for (int i = 0; i < 4; i++)
+				Assert::IsTrue(list[i].get<0>() == expected[i] && list[i].get<1>().value == expected[i]);
+
+			BasicColumnarChunkList<1, Allocator<unsigned char>, int, Tracked> copy = list;
+			Assert::IsTrue(copy.chunk_count() == 4 && copy[3].get<1>().value == 9);
+			list.clear();
+			copy.erase(1);
+			Assert::IsTrue(Tracked::alive == 3);
+		}
+	};
+
+	TEST_CLASS(PackedTests) {
+		TEST_METHOD(PackedValues) {
+			PackedChunkList<2, 128> list;
+			std::vector<int> expected;
+			unsigned state = 3;
+			for (int step = 0; step < 3000; step++) {
+				state = state * 1103515245 + 12345;
+				int value = (state >> 16) & 3;
+				std::size_t pos = (state >> 4) % (expected.size() + 1);
+				if (step % 4 == 3 && !expected.empty()) {
+					pos %= expected.size();
+					list.erase(pos);
+					expected.erase(expected.begin() + pos);
+				}
+				else {
+					list.insert(pos, value);
+					expected.insert(expected.begin() + pos, value);
+				}
+			}
+			Assert::IsTrue(list.size() == expected.size());
+			std::size_t i = 0;
+			for (int value : list)
+				Assert::IsTrue(value == expected[i++]);
+
+			for (int value = 0; value < 4; value++) {
+				Assert::IsTrue(list.count(value) == static_cast<std::size_t>(std::count(expected.begin(), expected.end(), value)));
+				std::size_t from = expected.size() / 3;
+				std::size_t found = std::find(expected.begin() + from, expected.end(), value) - expected.begin();
+				Assert::IsTrue(list.find(value, from) == found);
+			}
+
+			// Лишние старшие биты отбрасываются
+			list[5] = 7;
+			Assert::IsTrue(list[5] == 3);
+			list.flip();
+			Assert::IsTrue(list[5] == 0);
+			Assert::IsTrue(list.count(3) == static_cast<std::size_t>(std::count(expected.begin(), expected.end(), 0)) - (expected[5] == 0));
+
+			PackedChunkList<2, 128> copy = list;
+			copy.resize(100);
+			copy.resize(300, 2);
+			Assert::IsTrue(copy.size() == 300 && copy[99] == list[99] && copy[100] == 2 && copy.count(2) >= 200);
+			copy.fill(1);
+			Assert::IsTrue(copy.count(1) == 300 && copy.find(0) == 300);
+			copy.resize(0);
+			Assert::IsTrue(copy.empty() && copy.chunk_count() == 0);
+			Assert::ExpectException<std::out_of_range>([&] { list.at(list.size()); });
+		}
+
+		TEST_METHOD(PackedBool) {
+			ChunkList<bool, 256> flags = { true, false, true };
+			Assert::IsTrue(flags.size() == 3 && flags[0] && !flags[1]);
+			flags.append(10000, false);
+			for (std::size_t i = 0; i < flags.size(); i += 7)
+				flags[i] = true;
+			flags.push_front(false);
+			Assert::IsTrue(flags.size() == 10004);
+			Assert::IsTrue(flags.count(true) == (10003 + 6) / 7 + 1);
+			Assert::IsTrue(flags.find(true) == 1 && flags.find(true, 2) == 3 && flags.find(true, 9) == 15);
+			Assert::IsTrue(flags.chunk_count() <= 10004 / 128 + 1);
+
+			flags.flip();
+			Assert::IsTrue(flags.count(false) == (10003 + 6) / 7 + 1);
+			flags.back().flip();
+			flags.pop_front();
+			Assert::IsTrue(flags.front() == false && flags.size() == 10003);
+			const ChunkList<bool, 256>& view = flags;
+			Assert::IsTrue(!view.front() && view.back() == flags.back());
+			Assert::IsTrue(sizeof(ChunkList<bool>) < 64);
+		}
+	};
+
+	TEST_CLASS(ChunkCacheTests) {
+		TEST_METHOD(ThreadMagazines) {
+			using CachedList = ChunkList<int, 64, CachingAllocator<int>>;
+			{
+				CachedList list;
+				for (int i = 0; i < 1000; i++)
+					list.push_back(i);
+			}
+			ChunkCacheStats before = ChunkCache::stats();
+			{
+				CachedList list;
+				for (int i = 0; i < 1000; i++)
+					list.push_back(i);
+				Assert::IsTrue(list.back() == 999);
+			}
+			ChunkCacheStats after = ChunkCache::stats();
+			Assert::IsTrue(after.misses == before.misses);
+			Assert::IsTrue(after.hits > before.hits);
+
+			std::vector<std::thread> threads;
+			std::vector<long long> sums(4);
+			std::vector<CachedList> handoff(4);
+			for (int t = 0; t < 4; t++) {
+				threads.emplace_back([t, &sums, &handoff]() {
+					for (int round = 0; round < 50; round++) {
+						CachedList list;
+						for (int i = 0; i < 500; i++)
+							list.push_back(i);
+						sums[t] += list.back();
+					}
+					for (int i = 0; i < 300; i++)
+						handoff[t].push_back(i);
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+
+			for (int t = 0; t < 4; t++) {
+				Assert::IsTrue(sums[t] == 50 * 499);
+				Assert::IsTrue(handoff[t].size() == 300);
+				handoff[t].clear();
+			}
+		}
+	};
+
+	// Разрушается при выходе из программы уже после кэша главного потока и склада ChunkCache
+	ChunkList<int, 64, CachingAllocator<int>> cached_static_list;
+
+	TEST_CLASS(ChunkCacheTeardownTests) {
+		TEST_METHOD(ListsOutliveCaches) {
+			for (int i = 0; i < 1000; i++)
+				cached_static_list.push_back(i);
+
+			// thread_local список создан раньше кэша потока и разрушается после него
+			std::thread worker([]() {
+				thread_local ChunkList<int, 64, CachingAllocator<int>> list;
+				for (int i = 0; i < 1000; i++)
+					list.push_back(i);
+			});
+			worker.join();
+			Assert::IsTrue(cached_static_list.back() == 999);
+		}
+	};
+
+	TEST_CLASS(HugePageArenaTests) {
+		TEST_METHOD(ArenaAllocator) {
+			HugePageArena arena(8 * 1024 * 1024);
+			using ArenaList = ChunkList<int, 1024, HugePageAllocator<int>>;
+			{
+				ArenaList list{ HugePageAllocator<int>(arena) };
+				for (int i = 0; i < 1000000; i++)
+					list.push_back(i);
+				Assert::IsTrue(list[123456] == 123456);
+
+				HugePageStats stats = arena.stats();
+				Assert::IsTrue(stats.used <= stats.reserved);
+				Assert::IsTrue(stats.huge_page_bytes <= stats.used);
+				// Без mmap (например, в Windows) арена пуста и всё уходит в operator new
+				if (stats.reserved > 0) {
+					Assert::IsTrue(stats.used >= 1000000 * sizeof(int));
+					Assert::IsTrue(stats.fallback_bytes == 0);
+				}
+			}
+
+			// Блоки освобождённого списка переиспользуются, а не нарезаются заново
+			std::size_t used = arena.stats().used;
+			{
+				ArenaList list{ HugePageAllocator<int>(arena) };
+				for (int i = 0; i < 1000000; i++)
+					list.push_back(i);
+				Assert::IsTrue(list.back() == 999999);
+			}
+			Assert::IsTrue(arena.stats().used == used);
+
+			// Когда арена заканчивается, остаток уходит в operator new
+			HugePageArena small(1);
+			{
+				ArenaList list{ HugePageAllocator<int>(small) };
+				for (int i = 0; i < 1000000; i++)
+					list.push_back(i);
+				Assert::IsTrue(list.back() == 999999);
+				Assert::IsTrue(small.stats().fallback_bytes > 0);
+			}
+			Assert::IsTrue(small.stats().fallback_bytes == 0);
+		}
+	};
+
+	TEST_CLASS(NumaTests) {
+		TEST_METHOD(ParallelReserve) {
+			Assert::IsTrue(Numa::node_count() >= 1);
+
+			// Политика потока задаёт узел первого касания, пока аллокатор не привязал блок сам
+			ChunkList<int, 4096, NumaAllocator<int>> local;
+			std::vector<int> prepared(4, -1);
+			local.reserve_parallel(100000, 4, [&prepared](int thread_index) {
+				prepared[thread_index] = thread_index;
+				Numa::set_thread_policy(NumaPolicy{ NumaPlacement::Node, thread_index % Numa::node_count() });
+			});
+			for (int t = 0; t < 4; t++)
+				Assert::IsTrue(prepared[t] == t);
+			Assert::IsTrue(local.capacity() >= 100000);
+
+			// Блок с политикой Interleave: узлы частям задаются явно
+			NumaPolicy interleave{ NumaPlacement::Interleave };
+			ChunkList<int, 4096, NumaAllocator<int>> list{ NumaAllocator<int>(interleave) };
+			std::vector<NumaPolicy> placements;
+			for (int t = 0; t < 4; t++)
+				placements.push_back(NumaPolicy{ NumaPlacement::Node, t % Numa::node_count() });
+			list.reserve_parallel(100000, placements);
+
+			std::size_t capacity = list.capacity();
+			Assert::IsTrue(capacity >= 100000);
+			for (int i = 0; i < 100000; i++)
+				list.push_back(i);
+			Assert::IsTrue(list.capacity() == capacity);
+			Assert::IsTrue(list[54321] == 54321);
+
+			ChunkList<int, 64> plain;
+			plain.reserve_parallel(1000, 3);
+			Assert::ExpectException<std::invalid_argument>([&plain]() { plain.reserve_parallel(10, 0); });
+			Assert::ExpectException<std::invalid_argument>([&plain]() { plain.reserve_parallel(10, std::vector<NumaPolicy>()); });
+		}
+	};
+
+	TEST_CLASS(ChunkQueueTests) {
+		TEST_METHOD(SingleProducerSingleConsumer) {
+			SpscChunkQueue<int, 16, CountingAllocator<int>> queue;
+			std::vector<int> batch(40);
+			for (int i = 0; i < 40; i++)
+				batch[i] = i;
+			queue.push_batch(batch.begin(), batch.end());
+			int value = -1;
+			for (int i = 0; i < 40; i++) {
+				Assert::IsTrue(queue.try_pop(value));
+				Assert::IsTrue(value == i);
+			}
+			Assert::IsFalse(queue.try_pop(value));
+
+			// Прочитанные чанки возвращаются в хвост
+			AllocationLog::reset();
+			queue.push_batch(batch.begin(), batch.end());
+			std::vector<int> out;
+			Assert::IsTrue(queue.pop_batch(std::back_inserter(out), 100) == 40);
+			Assert::IsTrue(out == batch);
+			Assert::IsTrue(AllocationLog::allocations == 0);
+			Assert::IsTrue(queue.empty());
+
+			const int total = 100000;
+			long long sum = 0;
+			bool ordered = true;
+			std::thread consumer([&]() {
+				int expected = 0;
+				int item = 0;
+				while (expected < total) {
+					if (!queue.try_pop(item))
+						continue;
+					ordered = ordered && item == expected;
+					sum += item;
+					++expected;
+				}
+			});
+			for (int i = 0; i < total; i++)
+				queue.push(i);
+			consumer.join();
+			Assert::IsTrue(ordered);
+			Assert::IsTrue(sum == static_cast<long long>(total) * (total - 1) / 2);
+
+			SpscChunkQueue<std::string, 4> strings;
+			for (int i = 0; i < 10; i++)
+				strings.emplace(30, 'a');
+		}
+
+		TEST_METHOD(MultiProducerMultiConsumer) {
+			MpmcChunkQueue<int, 8> queue(30);
+			Assert::IsTrue(queue.capacity() == 32);
+			std::vector<int> batch(40, 1);
+			Assert::IsTrue(queue.try_push_batch(batch.begin(), batch.end()) == 32);
+			Assert::IsFalse(queue.try_push(1));
+			std::vector<int> out;
+			Assert::IsTrue(queue.try_pop_batch(std::back_inserter(out), 100) == 32);
+			int value = 0;
+			Assert::IsFalse(queue.try_pop(value));
+
+			const int threads = 4;
+			const int per_thread = 20000;
+			std::atomic<long long> sum{ 0 };
+			std::atomic<int> consumed{ 0 };
+			std::vector<std::thread> workers;
+			for (int t = 0; t < threads; t++) {
+				workers.emplace_back([&, t]() {
+					int items[8];
+					for (int i = 0; i < per_thread;) {
+						int count = std::min(8, per_thread - i);
+						for (int j = 0; j < count; j++)
+							items[j] = t * per_thread + i + j;
+						i += static_cast<int>(queue.try_push_batch(items, items + count));
+					}
+				});
+				workers.emplace_back([&]() {
+					int items[8];
+					while (consumed.load() < threads * per_thread) {
+						int count = static_cast<int>(queue.try_pop_batch(items, 8));
+						for (int j = 0; j < count; j++)
+							sum += items[j];
+						consumed += count;
+					}
+				});
+			}
+			for (std::thread& worker : workers)
+				worker.join();
+			long long n = threads * per_thread;
+			Assert::IsTrue(consumed.load() == n);
+			Assert::IsTrue(sum.load() == n * (n - 1) / 2);
+
+			MpmcChunkQueue<std::string, 4> strings(8);
+			Assert::IsTrue(strings.try_emplace(30, 'b'));
+
+			// Кольцо, его чанки, слоты и счётчики слотов берутся у аллокатора очереди
+			AllocationLog::reset();
+			{
+				MpmcChunkQueue<int, 8, CountingAllocator<int>> counted(30);
+				Assert::IsTrue(AllocationLog::allocations == 1 + 4 * 3);
+				Assert::IsTrue(counted.try_push(7));
+			}
+			Assert::IsTrue(AllocationLog::deallocations == AllocationLog::allocations);
+		}
 	};
 
 	TEST_CLASS(SwapTests) {
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+// Статические точки трассировки (USDT) провайдера chunklist. Включаются определением CHUNKLIST_ENABLE_PROBES
+// до подключения Chunk.h и только если доступен <sys/sdt.h> (пакет systemtap-sdt-dev). Иначе макросы
+// раскрываются в пустоту, и аргументы даже не вычисляются.
+//
+// Точки и аргументы:
+//   chunk_alloc(chunk, capacity)              — чанк получен у аллокатора
+//   chunk_free(chunk, capacity)               — чанк возвращён аллокатору
+//   chunk_split(chunk, new_chunk, moved)      — хвост чанка перенесён в новый чанк
+//   chunk_merge(chunk, next_chunk, moved)     — элементы следующего чанка перенесены в текущий
+//   compact(list, chunks_before, chunks_after) — уплотнение compact()
+//   bulk_insert(list, index, count)           — вставка count элементов одной операцией
+//   bulk_erase(list, removed)                 — потоковое удаление или обрезка хвоста
+//   reserve_slab(list, bytes, chunks)         — блок памяти под чанки reserve()
+//
+// Пример: sudo bpftrace -e 'usdt:./app:chunklist:chunk_split { @moved = hist(arg2); }'
+
+#if defined(CHUNKLIST_ENABLE_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define CHUNKLIST_PROBES_AVAILABLE 1
+#endif
+#endif
+
+#if defined(CHUNKLIST_PROBES_AVAILABLE)
+#define CHUNKLIST_PROBE2(name, a, b) DTRACE_PROBE2(chunklist, name, a, b)
+#define CHUNKLIST_PROBE3(name, a, b, c) DTRACE_PROBE3(chunklist, name, a, b, c)
+#else
+#define CHUNKLIST_PROBE2(name, a, b) ((void)0)
+#define CHUNKLIST_PROBE3(name, a, b, c) ((void)0)
+#endif
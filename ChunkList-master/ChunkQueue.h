@@ -0,0 +1,441 @@
+﻿#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "Chunk.h"
+
+
+namespace fefu_laboratory_two {
+	// Разделение счётчиков производителей и потребителей по разным кэш-линиям
+	inline constexpr std::size_t chunk_queue_cache_line = 64;
+
+	// Очередь одного производителя и одного потребителя поверх цепочки чанков. Производитель пишет в хвостовой чанк
+	// и публикует число записанных элементов, потребитель читает из головного. Прочитанные целиком чанки
+	// не освобождаются: производитель забирает их из начала цепочки и перецепляет в хвост, поэтому в устоявшемся
+	// режиме очередь не обращается к аллокатору. Обе стороны wait-free, кроме выделения нового чанка
+	template <typename T, int N = ChunkTraits<T>::chunk_size, typename Allocator = Allocator<T>>
+	class SpscChunkQueue {
+		static_assert(N > 0, "Chunk size must be positive");
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+
+		explicit SpscChunkQueue(const Allocator& alloc = Allocator()) : allocator(alloc) {
+			Segment* segment = create_segment();
+			head.store(segment, std::memory_order_relaxed);
+			tail = segment;
+			oldest = segment;
+		}
+
+		SpscChunkQueue(const SpscChunkQueue&) = delete;
+		SpscChunkQueue& operator=(const SpscChunkQueue&) = delete;
+
+		~SpscChunkQueue() {
+			// Чанки до головного прочитаны целиком, живые элементы есть только начиная с него
+			bool live = false;
+			for (Segment* segment = oldest; segment != nullptr;) {
+				Segment* next = segment->next.load(std::memory_order_relaxed);
+				live = live || segment == head.load(std::memory_order_relaxed);
+				if (live)
+					segment->chunk.destroy(segment->chunk.list + segment->consumed.load(std::memory_order_relaxed),
+						segment->chunk.list + segment->committed.load(std::memory_order_relaxed));
+				destroy_segment(segment);
+				segment = next;
+			}
+		}
+
+		// Сторона производителя
+
+		void push(const T& value) {
+			emplace(value);
+		}
+
+		void push(T&& value) {
+			emplace(std::move(value));
+		}
+
+		template <class... Args>
+		void emplace(Args&&... args) {
+			if (tail_count == N)
+				advance_tail();
+			tail->chunk.construct(tail->chunk.list + tail_count, std::forward<Args>(args)...);
+			tail->committed.store(++tail_count, std::memory_order_release);
+		}
+
+		// Пачка публикуется одной записью на каждый заполненный чанк
+		template <std::input_iterator InputIt>
+		void push_batch(InputIt first, InputIt last) {
+			while (first != last) {
+				if (tail_count == N)
+					advance_tail();
+				int count = tail_count;
+				try {
+					for (; first != last && count < N; ++first, ++count)
+						tail->chunk.construct(tail->chunk.list + count, *first);
+				}
+				catch (...) {
+					// Уже сконструированные элементы остаются в очереди
+					tail_count = count;
+					tail->committed.store(count, std::memory_order_release);
+					throw;
+				}
+				tail_count = count;
+				tail->committed.store(count, std::memory_order_release);
+			}
+		}
+
+		// Сторона потребителя
+
+		bool try_pop(T& out) {
+			Segment* segment = readable_segment();
+			if (segment == nullptr)
+				return false;
+
+			int consumed = segment->consumed.load(std::memory_order_relaxed);
+			T* slot = segment->chunk.list + consumed;
+			out = std::move(*slot);
+			segment->chunk.destroy(slot, slot + 1);
+			segment->consumed.store(consumed + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Извлекает до max элементов в out; возвращает их число
+		template <class OutputIt>
+		size_type pop_batch(OutputIt out, size_type max) {
+			size_type popped = 0;
+			while (popped < max) {
+				Segment* segment = readable_segment();
+				if (segment == nullptr)
+					break;
+
+				int consumed = segment->consumed.load(std::memory_order_relaxed);
+				int available = segment->committed.load(std::memory_order_acquire) - consumed;
+				int count = static_cast<int>(std::min<size_type>(available, max - popped));
+				T* slot = segment->chunk.list + consumed;
+				for (int i = 0; i < count; ++i, ++slot) {
+					*out = std::move(*slot);
+					++out;
+					segment->chunk.destroy(slot, slot + 1);
+					segment->consumed.store(++consumed, std::memory_order_relaxed);
+				}
+				popped += count;
+			}
+			return popped;
+		}
+
+		// Можно вызывать с любой стороны; ответ — снимок, который другая сторона может тут же изменить
+		bool empty() const {
+			Segment* segment = head.load(std::memory_order_acquire);
+			if (segment->consumed.load(std::memory_order_relaxed) < segment->committed.load(std::memory_order_acquire))
+				return false;
+			Segment* next = segment->next.load(std::memory_order_acquire);
+			return next == nullptr || next->committed.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		// Чанк с опубликованным числом записанных элементов. consumed меняет только потребитель,
+		// а атомарен он ради empty() на стороне производителя
+		struct Segment {
+			Chunk<T, Allocator> chunk;
+			std::atomic<int> committed{ 0 };
+			std::atomic<Segment*> next{ nullptr };
+			std::atomic<int> consumed{ 0 };
+
+			Segment(int size, const Allocator& alloc) : chunk(size, alloc) {}
+		};
+
+		using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Segment>;
+
+		// Головной чанк, если в нём есть что читать. Прочитанный целиком чанк оставляется производителю
+		Segment* readable_segment() {
+			Segment* segment = head.load(std::memory_order_relaxed);
+			if (segment->consumed.load(std::memory_order_relaxed) == N) {
+				Segment* next = segment->next.load(std::memory_order_acquire);
+				if (next == nullptr)
+					return nullptr;
+				head.store(next, std::memory_order_release);
+				segment = next;
+			}
+			if (segment->consumed.load(std::memory_order_relaxed) == segment->committed.load(std::memory_order_acquire))
+				return nullptr;
+			return segment;
+		}
+
+		// Новый хвост: самый старый чанк, если потребитель уже ушёл с него, иначе свежий
+		void advance_tail() {
+			Segment* segment = nullptr;
+			if (oldest != head.load(std::memory_order_acquire)) {
+				segment = oldest;
+				oldest = oldest->next.load(std::memory_order_relaxed);
+				segment->committed.store(0, std::memory_order_relaxed);
+				segment->next.store(nullptr, std::memory_order_relaxed);
+				segment->consumed.store(0, std::memory_order_relaxed);
+			}
+			else {
+				segment = create_segment();
+			}
+			tail->next.store(segment, std::memory_order_release);
+			tail = segment;
+			tail_count = 0;
+		}
+
+		Segment* create_segment() {
+			node_allocator alloc(allocator);
+			Segment* segment = std::allocator_traits<node_allocator>::allocate(alloc, 1);
+			try {
+				std::allocator_traits<node_allocator>::construct(alloc, segment, N, allocator);
+			}
+			catch (...) {
+				std::allocator_traits<node_allocator>::deallocate(alloc, segment, 1);
+				throw;
+			}
+			return segment;
+		}
+
+		void destroy_segment(Segment* segment) noexcept {
+			node_allocator alloc(allocator);
+			std::allocator_traits<node_allocator>::destroy(alloc, segment);
+			std::allocator_traits<node_allocator>::deallocate(alloc, segment, 1);
+		}
+
+		Allocator allocator;
+		// Потребитель
+		alignas(chunk_queue_cache_line) std::atomic<Segment*> head{ nullptr };
+		// Производитель
+		alignas(chunk_queue_cache_line) Segment* tail = nullptr;
+		Segment* oldest = nullptr;
+		int tail_count = 0;
+	};
+
+	// Ограниченная очередь многих производителей и потребителей: кольцо из чанков по N слотов (N округляется
+	// до степени двойки), ёмкость — степень двойки не меньше capacity. У каждого слота свой счётчик
+	// последовательности (схема Вьюкова), поэтому очередь lock-free, а чанки кольца переиспользуются по кругу.
+	// Пачки занимают несколько подряд идущих слотов одной операцией CAS.
+	// Слот занимается до записи элемента, поэтому перенос в слот и из него не должен бросать исключений
+	template <typename T, int N = ChunkTraits<T>::chunk_size, typename Allocator = Allocator<T>>
+	class MpmcChunkQueue {
+		static_assert(N > 0, "Chunk size must be positive");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "Queue elements must be nothrow move constructible");
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+
+		explicit MpmcChunkQueue(size_type capacity, const Allocator& alloc = Allocator()) : allocator(alloc) {
+			if (capacity == 0)
+				throw std::invalid_argument("Capacity must be positive");
+
+			size_type chunk_slots = std::bit_ceil(static_cast<size_type>(N));
+			size_type chunks = std::bit_ceil((capacity + chunk_slots - 1) / chunk_slots);
+			slot_mask = chunk_slots - 1;
+			chunk_shift = std::countr_zero(chunk_slots);
+			chunk_mask = chunks - 1;
+			ring_capacity = chunks * chunk_slots;
+
+			try {
+				ring.reserve(chunks);
+				for (size_type i = 0; i < chunks; ++i)
+					ring.push_back(create_ring_chunk(static_cast<int>(chunk_slots), i * chunk_slots));
+			}
+			catch (...) {
+				destroy_ring();
+				throw;
+			}
+		}
+
+		MpmcChunkQueue(const MpmcChunkQueue&) = delete;
+		MpmcChunkQueue& operator=(const MpmcChunkQueue&) = delete;
+
+		~MpmcChunkQueue() {
+			size_type last = enqueue_pos.load(std::memory_order_relaxed);
+			for (size_type pos = dequeue_pos.load(std::memory_order_relaxed); pos != last; ++pos) {
+				T* element = slot(pos);
+				chunk_of(pos).chunk.destroy(element, element + 1);
+			}
+			destroy_ring();
+		}
+
+		size_type capacity() const noexcept {
+			return ring_capacity;
+		}
+
+		bool try_push(const T& value) {
+			return try_emplace(value);
+		}
+
+		bool try_push(T&& value) {
+			return try_emplace(std::move(value));
+		}
+
+		// Элемент сначала конструируется вне очереди, чтобы исключение не оставило занятый пустой слот
+		template <class... Args>
+		bool try_emplace(Args&&... args) {
+			T value(std::forward<Args>(args)...);
+			size_type pos = 0;
+			if (claim(enqueue_pos, 0, 1, pos) == 0)
+				return false;
+			chunk_of(pos).chunk.construct(slot(pos), std::move(value));
+			sequence(pos).store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool try_pop(T& out) {
+			size_type pos = 0;
+			if (claim(dequeue_pos, 1, 1, pos) == 0)
+				return false;
+			out = take(pos);
+			return true;
+		}
+
+		// Кладёт начало диапазона [first, last), сколько поместится подряд; возвращает число положенных элементов.
+		// Элементы конструируются из *first прямо в занятых слотах, поэтому это не должно бросать исключений:
+		// для типов с бросающим копированием передавайте std::make_move_iterator
+		template <std::forward_iterator ForwardIt>
+		size_type try_push_batch(ForwardIt first, ForwardIt last) {
+			static_assert(std::is_nothrow_constructible_v<T, std::iter_reference_t<ForwardIt>>,
+				"Batch elements must be nothrow constructible from the iterator");
+
+			size_type pos = 0;
+			size_type count = claim(enqueue_pos, 0, static_cast<size_type>(std::distance(first, last)), pos);
+			for (size_type i = 0; i < count; ++i, ++first) {
+				chunk_of(pos + i).chunk.construct(slot(pos + i), *first);
+				sequence(pos + i).store(pos + i + 1, std::memory_order_release);
+			}
+			return count;
+		}
+
+		// Извлекает до max элементов подряд в out; возвращает их число
+		template <class OutputIt>
+		size_type try_pop_batch(OutputIt out, size_type max) {
+			size_type pos = 0;
+			size_type count = claim(dequeue_pos, 1, max, pos);
+			size_type i = 0;
+			try {
+				for (; i < count; ++i) {
+					*out = take(pos + i);
+					++out;
+				}
+			}
+			catch (...) {
+				// Запись в out бросила: оставшиеся занятые слоты всё равно освобождаются, их элементы теряются
+				for (++i; i < count; ++i)
+					take(pos + i);
+				throw;
+			}
+			return count;
+		}
+
+	private:
+		using sequence_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<size_type>>;
+
+		// Слоты чанка и их счётчики; счётчики берутся у того же аллокатора, что и элементы
+		struct RingChunk {
+			Chunk<T, Allocator> chunk;
+			sequence_allocator allocator;
+			std::atomic<size_type>* sequence = nullptr;
+
+			// Счётчик слота j начинается с first + j: слот свободен для записи на первом круге
+			RingChunk(int size, const Allocator& alloc, size_type first) : chunk(size, alloc), allocator(alloc) {
+				sequence = std::allocator_traits<sequence_allocator>::allocate(allocator, size);
+				for (int j = 0; j < size; ++j)
+					std::allocator_traits<sequence_allocator>::construct(allocator, sequence + j, first + j);
+			}
+
+			RingChunk(const RingChunk&) = delete;
+			RingChunk& operator=(const RingChunk&) = delete;
+
+			~RingChunk() {
+				for (int j = 0; j < chunk.chunk_size; ++j)
+					std::allocator_traits<sequence_allocator>::destroy(allocator, sequence + j);
+				std::allocator_traits<sequence_allocator>::deallocate(allocator, sequence, chunk.chunk_size);
+			}
+		};
+
+		using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<RingChunk>;
+		using ring_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<RingChunk*>;
+
+		RingChunk* create_ring_chunk(int size, size_type first) {
+			node_allocator alloc(allocator);
+			RingChunk* chunk = std::allocator_traits<node_allocator>::allocate(alloc, 1);
+			try {
+				std::allocator_traits<node_allocator>::construct(alloc, chunk, size, allocator, first);
+			}
+			catch (...) {
+				std::allocator_traits<node_allocator>::deallocate(alloc, chunk, 1);
+				throw;
+			}
+			return chunk;
+		}
+
+		void destroy_ring() noexcept {
+			node_allocator alloc(allocator);
+			for (RingChunk* chunk : ring) {
+				std::allocator_traits<node_allocator>::destroy(alloc, chunk);
+				std::allocator_traits<node_allocator>::deallocate(alloc, chunk, 1);
+			}
+			ring.clear();
+		}
+
+		RingChunk& chunk_of(size_type pos) const noexcept {
+			return *ring[(pos >> chunk_shift) & chunk_mask];
+		}
+
+		T* slot(size_type pos) const noexcept {
+			return chunk_of(pos).chunk.list + (pos & slot_mask);
+		}
+
+		std::atomic<size_type>& sequence(size_type pos) const noexcept {
+			return chunk_of(pos).sequence[pos & slot_mask];
+		}
+
+		// Занимает до max подряд идущих слотов, начиная с текущей позиции counter. Слот pos готов,
+		// когда его счётчик равен pos + ready (0 — свободен для записи, 1 — записан). Возвращает число слотов
+		// и первую позицию в pos
+		size_type claim(std::atomic<size_type>& counter, size_type ready, size_type max, size_type& pos) {
+			if (max == 0)
+				return 0;
+
+			pos = counter.load(std::memory_order_relaxed);
+			for (;;) {
+				size_type count = 0;
+				while (count < max && count < ring_capacity
+					&& sequence(pos + count).load(std::memory_order_acquire) == pos + count + ready)
+					++count;
+
+				if (count == 0) {
+					std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence(pos).load(std::memory_order_acquire) - (pos + ready));
+					if (diff < 0)
+						return 0;
+					pos = counter.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (counter.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+					return count;
+			}
+		}
+
+		// Забирает элемент из занятого потребителем слота и отдаёт слот следующему кругу производителей
+		T take(size_type pos) noexcept {
+			T* element = slot(pos);
+			T value(std::move(*element));
+			chunk_of(pos).chunk.destroy(element, element + 1);
+			sequence(pos).store(pos + ring_capacity, std::memory_order_release);
+			return value;
+		}
+
+		Allocator allocator;
+		std::vector<RingChunk*, ring_allocator> ring{ ring_allocator(allocator) };
+		size_type ring_capacity = 0;
+		size_type slot_mask = 0;
+		size_type chunk_mask = 0;
+		int chunk_shift = 0;
+		alignas(chunk_queue_cache_line) std::atomic<size_type> enqueue_pos{ 0 };
+		alignas(chunk_queue_cache_line) std::atomic<size_type> dequeue_pos{ 0 };
+	};
+}
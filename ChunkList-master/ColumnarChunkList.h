@@ -0,0 +1,422 @@
+﻿#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "BlockChain.h"
+#include "Chunk.h"
+
+
+namespace fefu_laboratory_two {
+	// Строк в чанке ColumnarChunkList без явного N: столбцы одного чанка вместе занимают около 4 КиБ
+	template <typename... Fields>
+	struct ColumnarChunkTraits {
+		static constexpr int chunk_size = static_cast<int>(std::bit_floor(std::max<std::size_t>(4096 / (sizeof(Fields) + ...), 1)));
+	};
+
+	// Ссылка на строку ColumnarChunkList: по указателю на поле строки в каждом столбце.
+	// Поля доступны через get<I>() и структурные привязки, auto [time, id, value] = list[i] пишет прямо в столбцы
+	template <bool Const, typename... Fields>
+	class ColumnarRowReference {
+	public:
+		template <std::size_t I>
+		using field_type = std::conditional_t<Const, const std::tuple_element_t<I, std::tuple<Fields...>>,
+			std::tuple_element_t<I, std::tuple<Fields...>>>;
+		using pointers = std::tuple<std::conditional_t<Const, const Fields*, Fields*>...>;
+
+		explicit ColumnarRowReference(const pointers& fields) noexcept : fields(fields) {}
+
+		ColumnarRowReference(const ColumnarRowReference& other) noexcept = default;
+
+		ColumnarRowReference(const ColumnarRowReference<false, Fields...>& other) noexcept requires Const : fields(other.fields) {}
+
+		// Присваивание записывает значения полей, а не перенацеливает ссылку
+		ColumnarRowReference& operator=(const ColumnarRowReference& other) requires (!Const) {
+			return *this = static_cast<std::tuple<Fields...>>(other);
+		}
+
+		ColumnarRowReference& operator=(const std::tuple<Fields...>& row) requires (!Const) {
+			assign(row, std::index_sequence_for<Fields...>());
+			return *this;
+		}
+
+		template <std::size_t I>
+		field_type<I>& get() const noexcept {
+			return *std::get<I>(fields);
+		}
+
+		operator std::tuple<Fields...>() const {
+			return std::apply([](const auto*... field) { return std::tuple<Fields...>(*field...); }, fields);
+		}
+
+		friend bool operator==(const ColumnarRowReference& lhs, const std::tuple<Fields...>& rhs) {
+			return static_cast<std::tuple<Fields...>>(lhs) == rhs;
+		}
+
+	private:
+		template <bool, typename...>
+		friend class ColumnarRowReference;
+
+		template <std::size_t... I>
+		void assign(const std::tuple<Fields...>& row, std::index_sequence<I...>) {
+			((*std::get<I>(fields) = std::get<I>(row)), ...);
+		}
+
+		pointers fields;
+	};
+
+	// Чанк ColumnarChunkList: до N строк, разложенных в sizeof...(Fields) столбцов, по Chunk на поле
+	template <int N, typename Allocator, typename... Fields>
+	struct ColumnarBlock {
+		template <typename F>
+		using field_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<F>;
+
+		// Столбец чанка; элементы уничтожает деструктор Chunk, поэтому num_of_elements у всех столбцов блока одинаков
+		template <typename F>
+		struct Column : Chunk<F, field_allocator<F>> {
+			explicit Column(const Allocator& alloc) : Chunk<F, field_allocator<F>>(N, field_allocator<F>(alloc)) {}
+			Column(const Column&) = delete;
+			Column& operator=(const Column&) = delete;
+		};
+
+		std::tuple<Column<Fields>...> columns;
+		ColumnarBlock* prev = nullptr;
+		ColumnarBlock* next = nullptr;
+
+		template <typename F>
+		static const Allocator& column_allocator(const Allocator& alloc) noexcept {
+			return alloc;
+		}
+
+		explicit ColumnarBlock(const Allocator& alloc) : columns(column_allocator<Fields>(alloc)...) {}
+
+		int count() const noexcept {
+			return std::get<0>(columns).num_of_elements;
+		}
+
+		void set_count(int rows) noexcept {
+			std::apply([rows](auto&... column) { ((column.num_of_elements = rows), ...); }, columns);
+		}
+
+		// Переносит строки [first, last) в сырые слоты to, начиная с dest; to может совпадать с this
+		void relocate(int first, int last, ColumnarBlock* to, int dest) {
+			relocate(first, last, to, dest, std::index_sequence_for<Fields...>());
+		}
+
+		void destroy(int first, int last) noexcept {
+			std::apply([=](auto&... column) { (column.destroy(column.list + first, column.list + last), ...); }, columns);
+		}
+
+		// Поля конструируются по порядку; если бросит очередное, уже созданные уничтожаются
+		template <std::size_t... I, class... Args>
+		void construct_row(int slot, std::index_sequence<I...>, Args&&... args) {
+			std::size_t built = 0;
+			try {
+				((std::get<I>(columns).construct(std::get<I>(columns).list + slot, std::forward<Args>(args)), ++built), ...);
+			}
+			catch (...) {
+				((I < built ? std::get<I>(columns).destroy(std::get<I>(columns).list + slot,
+					std::get<I>(columns).list + slot + 1) : void()), ...);
+				throw;
+			}
+		}
+
+		// Копирует строки other в пустой блок; счётчик растёт после каждой строки, и при исключении
+		// деструктор уничтожит ровно созданные
+		void copy_from(const ColumnarBlock& other) {
+			for (int row = 0; row < other.count(); ++row) {
+				copy_row(other, row, std::index_sequence_for<Fields...>());
+				set_count(row + 1);
+			}
+		}
+
+	private:
+		template <std::size_t... I>
+		void relocate(int first, int last, ColumnarBlock* to, int dest, std::index_sequence<I...>) {
+			(std::get<I>(columns).relocate(std::get<I>(columns).list + first, std::get<I>(columns).list + last,
+				std::get<I>(to->columns).list + dest), ...);
+		}
+
+		template <std::size_t... I>
+		void copy_row(const ColumnarBlock& other, int row, std::index_sequence<I...> fields) {
+			construct_row(row, fields, std::as_const(std::get<I>(other.columns).list[row])...);
+		}
+	};
+
+	// Список строк, в котором каждое поле хранится своим столбцом: чанк — это до N строк, разложенных
+	// в sizeof...(Fields) непрерывных массивов, по Chunk на поле. Проход по одному полю читает только его столбец,
+	// а for_each_span отдаёт столбец чанк за чанком как std::span, и такие циклы компилятор векторизует.
+	// Цепочку чанков ведёт BlockChain, деление полного чанка при вставке устроено как в ChunkList
+	template <int N, typename Allocator, typename... Fields>
+	class BasicColumnarChunkList : public BlockChain<ColumnarBlock<N, Allocator, Fields...>, Allocator> {
+		static_assert(N > 0, "Chunk size must be positive");
+		static_assert(sizeof...(Fields) > 0, "At least one field is required");
+
+		using Block = ColumnarBlock<N, Allocator, Fields...>;
+		using base = BlockChain<Block, Allocator>;
+		using base::first_block;
+		using base::tail_block;
+		using base::list_size;
+		using base::locate;
+		using base::insert_block_after;
+		using base::unlink_block;
+
+		template <bool Const>
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::tuple<Fields...>;
+			using difference_type = std::ptrdiff_t;
+			using reference = ColumnarRowReference<Const, Fields...>;
+
+			Iterator() noexcept = default;
+			Iterator(Block* block, int offset) noexcept : block(block), offset(offset) {}
+
+			reference operator*() const noexcept {
+				return row_at<Const>(block, offset);
+			}
+
+			Iterator& operator++() noexcept {
+				if (++offset == block->count()) {
+					block = block->next;
+					offset = 0;
+				}
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept {
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+				return lhs.block == rhs.block && lhs.offset == rhs.offset;
+			}
+
+		private:
+			Block* block = nullptr;
+			int offset = 0;
+		};
+
+	public:
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+		using row_type = std::tuple<Fields...>;
+		using reference = ColumnarRowReference<false, Fields...>;
+		using const_reference = ColumnarRowReference<true, Fields...>;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+		template <std::size_t I>
+		using field_type = std::tuple_element_t<I, row_type>;
+
+		static constexpr int chunk_size = N;
+
+		explicit BasicColumnarChunkList(const Allocator& alloc = Allocator()) : base(alloc) {}
+
+		reference at(size_type pos) {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+			return (*this)[pos];
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+			return (*this)[pos];
+		}
+
+		reference operator[](size_type pos) {
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			return row_at<false>(block, offset);
+		}
+
+		const_reference operator[](size_type pos) const {
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			return row_at<true>(block, offset);
+		}
+
+		reference front() {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return row_at<false>(first_block, 0);
+		}
+
+		const_reference front() const {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return row_at<true>(first_block, 0);
+		}
+
+		reference back() {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return row_at<false>(tail_block, tail_block->count() - 1);
+		}
+
+		const_reference back() const {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return row_at<true>(tail_block, tail_block->count() - 1);
+		}
+
+		iterator begin() noexcept {
+			return iterator(first_block, 0);
+		}
+
+		iterator end() noexcept {
+			return iterator();
+		}
+
+		const_iterator begin() const noexcept {
+			return const_iterator(first_block, 0);
+		}
+
+		const_iterator end() const noexcept {
+			return const_iterator();
+		}
+
+		// Столбец I чанк за чанком: f получает std::span с полем I всех строк очередного чанка
+		template <std::size_t I, class F>
+		void for_each_span(F&& f) {
+			for (Block* block = first_block; block != nullptr; block = block->next)
+				f(std::span<field_type<I>>(std::get<I>(block->columns).list, block->count()));
+		}
+
+		template <std::size_t I, class F>
+		void for_each_span(F&& f) const {
+			for (Block* block = first_block; block != nullptr; block = block->next)
+				f(std::span<const field_type<I>>(std::get<I>(block->columns).list, block->count()));
+		}
+
+		void push_back(const row_type& row) {
+			std::apply([this](const auto&... field) { emplace_back(field...); }, row);
+		}
+
+		void push_back(row_type&& row) {
+			std::apply([this](auto&... field) { emplace_back(std::move(field)...); }, row);
+		}
+
+		// Поля строки передаются по одному, в порядке Fields
+		template <class... Args>
+			requires (sizeof...(Args) == sizeof...(Fields))
+		reference emplace_back(Args&&... args) {
+			if (tail_block == nullptr || tail_block->count() == N)
+				insert_block_after(tail_block);
+			int offset = tail_block->count();
+			tail_block->construct_row(offset, std::index_sequence_for<Fields...>(), std::forward<Args>(args)...);
+			tail_block->set_count(offset + 1);
+			++list_size;
+			return row_at<false>(tail_block, offset);
+		}
+
+		void pop_back() {
+			if (list_size == 0)
+				return;
+
+			int rows = tail_block->count();
+			tail_block->destroy(rows - 1, rows);
+			tail_block->set_count(rows - 1);
+			--list_size;
+			if (rows == 1)
+				unlink_block(tail_block);
+		}
+
+		void insert(size_type pos, const row_type& row) {
+			std::apply([&](const auto&... field) { emplace(pos, field...); }, row);
+		}
+
+		// Вставляет строку перед pos. Полный чанк делится пополам, как в ChunkList, а вставка в конец полного
+		// чанка открывает новый, чтобы дописывание не оставляло полупустых чанков
+		template <class... Args>
+			requires (sizeof...(Args) == sizeof...(Fields))
+		reference emplace(size_type pos, Args&&... args) {
+			if (pos > list_size)
+				throw std::out_of_range("Out of range");
+			if (pos == list_size)
+				return emplace_back(std::forward<Args>(args)...);
+
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			if (block->count() == N) {
+				constexpr int half = N / 2;
+				Block* new_block = insert_block_after(block);
+				block->relocate(half, N, new_block, 0);
+				block->set_count(half);
+				new_block->set_count(N - half);
+				// При N == 1 половина пуста: строка целиком ушла в new_block, новая встаёт в опустевший чанк
+				if (offset >= half && half > 0) {
+					offset -= half;
+					block = new_block;
+				}
+			}
+
+			int rows = block->count();
+			block->relocate(offset, rows, block, offset + 1);
+			try {
+				block->construct_row(offset, std::index_sequence_for<Fields...>(), std::forward<Args>(args)...);
+			}
+			catch (...) {
+				block->relocate(offset + 1, rows + 1, block, offset);
+				if (rows == 0)
+					unlink_block(block);
+				throw;
+			}
+			block->set_count(rows + 1);
+			++list_size;
+			return row_at<false>(block, offset);
+		}
+
+		void erase(size_type pos) {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			int rows = block->count();
+			block->destroy(offset, offset + 1);
+			block->relocate(offset + 1, rows, block, offset);
+			block->set_count(rows - 1);
+			--list_size;
+			if (rows == 1)
+				unlink_block(block);
+		}
+
+	private:
+		template <bool Const>
+		static ColumnarRowReference<Const, Fields...> row_at(Block* block, int offset) noexcept {
+			return std::apply([offset](auto&... column) {
+				return ColumnarRowReference<Const, Fields...>(
+					typename ColumnarRowReference<Const, Fields...>::pointers(column.list + offset...));
+			}, block->columns);
+		}
+	};
+
+	template <int N, typename Allocator, typename... Fields>
+	void swap(BasicColumnarChunkList<N, Allocator, Fields...>& lhs, BasicColumnarChunkList<N, Allocator, Fields...>& rhs) noexcept {
+		lhs.swap(rhs);
+	}
+
+	// ColumnarChunkList<std::int64_t, int, double> — строки {timestamp, id, value} тремя столбцами
+	template <typename... Fields>
+	using ColumnarChunkList = BasicColumnarChunkList<ColumnarChunkTraits<Fields...>::chunk_size, Allocator<unsigned char>, Fields...>;
+}
+
+namespace std {
+	template <bool Const, typename... Fields>
+	struct tuple_size<fefu_laboratory_two::ColumnarRowReference<Const, Fields...>>
+		: integral_constant<size_t, sizeof...(Fields)> {};
+
+	template <size_t I, bool Const, typename... Fields>
+	struct tuple_element<I, fefu_laboratory_two::ColumnarRowReference<Const, Fields...>> {
+		using type = typename fefu_laboratory_two::ColumnarRowReference<Const, Fields...>::template field_type<I>;
+	};
+}
@@ -0,0 +1,221 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+
+namespace fefu_laboratory_two {
+	// Состояние арены. huge_page_bytes — сколько памяти арены ядро действительно отдало huge pages
+	// (по AnonHugePages из /proc/self/smaps), fallback_bytes — блоки, выделенные через operator new,
+	// когда арена закончилась или mmap недоступен
+	struct HugePageStats {
+		std::size_t reserved = 0;
+		std::size_t used = 0;
+		std::size_t huge_page_bytes = 0;
+		std::size_t fallback_bytes = 0;
+		bool huge_pages_requested = false;
+	};
+
+	// Арена для очень больших списков: один участок адресного пространства резервируется через mmap,
+	// выравнивается на 2 МиБ и помечается MADV_HUGEPAGE. Чанки нарезаются из него подряд, освобождённые блоки
+	// переиспользуются по размеру, а сама память возвращается системе только вместе с ареной.
+	// Без THP арена работает на обычных страницах, без mmap — через operator new
+	class HugePageArena {
+	public:
+		static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+		explicit HugePageArena(std::size_t capacity) {
+			capacity = (capacity + huge_page_size - 1) / huge_page_size * huge_page_size;
+#if defined(__linux__)
+			std::size_t length = capacity + huge_page_size;
+			void* raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (raw == MAP_FAILED)
+				return;
+
+			// Обрезаем края, чтобы начало участка легло на границу huge page
+			std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+			std::uintptr_t aligned = (address + huge_page_size - 1) / huge_page_size * huge_page_size;
+			std::size_t head = aligned - address;
+			if (head != 0)
+				::munmap(raw, head);
+			if (length - head > capacity)
+				::munmap(reinterpret_cast<void*>(aligned + capacity), length - head - capacity);
+
+			base = reinterpret_cast<unsigned char*>(aligned);
+			reserved = capacity;
+#if defined(MADV_HUGEPAGE)
+			huge_pages_requested = ::madvise(base, reserved, MADV_HUGEPAGE) == 0;
+#endif
+#else
+			static_cast<void>(capacity);
+#endif
+		}
+
+		HugePageArena(const HugePageArena&) = delete;
+		HugePageArena& operator=(const HugePageArena&) = delete;
+
+		~HugePageArena() {
+#if defined(__linux__)
+			if (base != nullptr)
+				::munmap(base, reserved);
+#endif
+		}
+
+		void* allocate(std::size_t bytes, std::size_t alignment) {
+			std::lock_guard<std::mutex> lock(mutex);
+			std::vector<void*>& blocks = shelf(bytes, alignment);
+			if (!blocks.empty()) {
+				void* p = blocks.back();
+				blocks.pop_back();
+				return p;
+			}
+
+			std::size_t offset = (used + alignment - 1) / alignment * alignment;
+			if (base != nullptr && offset + bytes <= reserved) {
+				used = offset + bytes;
+				return base + offset;
+			}
+
+			fallback_bytes += bytes;
+			return ::operator new(bytes, std::align_val_t(alignment));
+		}
+
+		void deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+			if (!owns(p)) {
+				std::lock_guard<std::mutex> lock(mutex);
+				fallback_bytes -= bytes;
+				::operator delete(p, std::align_val_t(alignment));
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			try {
+				shelf(bytes, alignment).push_back(p);
+			}
+			catch (...) {
+				// Блок не удалось запомнить: он пропадёт до уничтожения арены
+			}
+		}
+
+		bool owns(const void* p) const noexcept {
+			const unsigned char* ptr = static_cast<const unsigned char*>(p);
+			return base != nullptr && ptr >= base && ptr < base + reserved;
+		}
+
+		HugePageStats stats() const {
+			HugePageStats result;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				result.reserved = reserved;
+				result.used = used;
+				result.fallback_bytes = fallback_bytes;
+				result.huge_pages_requested = huge_pages_requested;
+			}
+			result.huge_page_bytes = std::min(anon_huge_page_bytes(), result.used);
+			return result;
+		}
+
+	private:
+		struct Shelf {
+			std::size_t bytes;
+			std::size_t alignment;
+			std::vector<void*> blocks;
+		};
+
+		std::vector<void*>& shelf(std::size_t bytes, std::size_t alignment) {
+			for (Shelf& shelf : shelves)
+				if (shelf.bytes == bytes && shelf.alignment == alignment)
+					return shelf.blocks;
+			shelves.push_back(Shelf{ bytes, alignment, {} });
+			return shelves.back().blocks;
+		}
+
+		// Суммирует AnonHugePages по всем отображениям, пересекающимся с участком арены
+		std::size_t anon_huge_page_bytes() const {
+			if (base == nullptr)
+				return 0;
+
+			std::ifstream smaps("/proc/self/smaps");
+			std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(base);
+			std::uintptr_t end = begin + reserved;
+			std::size_t total = 0;
+			bool inside = false;
+			std::string line;
+			while (std::getline(smaps, line)) {
+				std::size_t dash = line.find('-');
+				std::size_t space = line.find(' ');
+				if (dash != std::string::npos && space != std::string::npos && dash < space
+					&& line.find_first_not_of("0123456789abcdef") == dash) {
+					std::uintptr_t from = std::stoull(line.substr(0, dash), nullptr, 16);
+					std::uintptr_t to = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+					inside = from < end && to > begin;
+					continue;
+				}
+				if (inside && line.rfind("AnonHugePages:", 0) == 0) {
+					std::istringstream fields(line.substr(14));
+					std::size_t kilobytes = 0;
+					fields >> kilobytes;
+					total += kilobytes * 1024;
+				}
+			}
+			return total;
+		}
+
+		mutable std::mutex mutex;
+		unsigned char* base = nullptr;
+		std::size_t reserved = 0;
+		std::size_t used = 0;
+		std::size_t fallback_bytes = 0;
+		bool huge_pages_requested = false;
+		std::vector<Shelf> shelves;
+	};
+
+	// Аллокатор поверх арены: ChunkList<T, N, HugePageAllocator<T>> list(HugePageAllocator<T>(arena)).
+	// Арена должна пережить все списки, которые из неё выделяют. Без арены память берётся у operator new.
+	// Долю huge pages сообщает arena.stats(), а не list.stats(): ядро выдаёт huge pages участкам отображения,
+	// а не отдельным выделениям, и участок в 2 МиБ делят чанки всех списков арены, поэтому на один список
+	// эту долю не разделить. Для замера держите большой список в отдельной арене
+	template <typename T>
+	class HugePageAllocator {
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		HugePageArena* arena = nullptr;
+
+		constexpr HugePageAllocator() noexcept = default;
+
+		constexpr explicit HugePageAllocator(HugePageArena& arena) noexcept : arena(&arena) {};
+
+		template <class U>
+		constexpr HugePageAllocator(const HugePageAllocator<U>& other) noexcept : arena(other.arena) {};
+
+		T* allocate(size_type N) {
+			if (arena == nullptr)
+				return static_cast<T*>(::operator new(N * sizeof(T), std::align_val_t(alignof(T))));
+			return static_cast<T*>(arena->allocate(N * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_type N) noexcept {
+			if (arena == nullptr)
+				::operator delete(p, std::align_val_t(alignof(T)));
+			else
+				arena->deallocate(p, N * sizeof(T), alignof(T));
+		}
+	};
+
+	template <class T, class U>
+	constexpr bool operator==(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept {
+		return lhs.arena == rhs.arena;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+// Минимальная замена CppUnitTest.h из Visual Studio для сборки тестов под Linux (CMake, цель chunklist_tests).
+// Поддерживает то, чем пользуются тесты ChunkList.cpp: TEST_CLASS, TEST_METHOD и основные проверки Assert
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Microsoft {
+	namespace VisualStudio {
+		namespace CppUnitTestFramework {
+			class AssertFailedException : public std::runtime_error {
+			public:
+				using std::runtime_error::runtime_error;
+			};
+
+			struct TestEntry {
+				std::string name;
+				std::function<void()> run;
+			};
+
+			class TestRegistry {
+			public:
+				static std::vector<TestEntry>& tests() {
+					static std::vector<TestEntry> entries;
+					return entries;
+				}
+			};
+
+			struct TestRegistrar {
+				TestRegistrar(const char* class_name, const char* method_name, void (*run)()) {
+					TestRegistry::tests().push_back(TestEntry{ std::string(class_name) + "::" + method_name, run });
+				}
+			};
+
+			template <class Test, class Name>
+			class TestClass {
+			public:
+				using self_type = Test;
+
+				static const char* class_name() noexcept {
+					return Name::value;
+				}
+			};
+
+			class Assert {
+			public:
+				static void IsTrue(bool condition, const wchar_t* message = nullptr) {
+					if (!condition)
+						fail("IsTrue", message);
+				}
+
+				static void IsFalse(bool condition, const wchar_t* message = nullptr) {
+					if (condition)
+						fail("IsFalse", message);
+				}
+
+				template <typename T, typename U>
+				static void AreEqual(const T& expected, const U& actual, const wchar_t* message = nullptr) {
+					if (!(expected == actual))
+						fail("AreEqual", message);
+				}
+
+				template <typename T, typename U>
+				static void AreNotEqual(const T& notExpected, const U& actual, const wchar_t* message = nullptr) {
+					if (notExpected == actual)
+						fail("AreNotEqual", message);
+				}
+
+				template <typename E, typename F>
+				static void ExpectException(F functor, const wchar_t* message = nullptr) {
+					try {
+						functor();
+					}
+					catch (const E&) {
+						return;
+					}
+					catch (...) {
+					}
+					fail("ExpectException", message);
+				}
+
+				static void Fail(const wchar_t* message = nullptr) {
+					fail("Fail", message);
+				}
+
+			private:
+				static void fail(const char* check, const wchar_t* message) {
+					std::string text = check;
+					if (message != nullptr) {
+						text += ": ";
+						for (const wchar_t* c = message; *c != L'\0'; ++c)
+							text += *c < 128 ? static_cast<char>(*c) : '?';
+					}
+					throw AssertFailedException(text);
+				}
+			};
+		}
+	}
+}
+
+#define TEST_CLASS(className) \
+	struct className##_TestClassName { static constexpr const char* value = #className; }; \
+	struct className : public ::Microsoft::VisualStudio::CppUnitTestFramework::TestClass<className, className##_TestClassName>
+
+#define TEST_METHOD(methodName) \
+	static void run_##methodName() { self_type test; test.methodName(); } \
+	static inline const ::Microsoft::VisualStudio::CppUnitTestFramework::TestRegistrar registrar_##methodName{ \
+		class_name(), #methodName, &run_##methodName }; \
+	void methodName()
@@ -0,0 +1,31 @@
+// Запуск тестов под Linux: chunklist_tests [подстрока имени] — выполняет тесты, в имени которых есть подстрока
+#include "CppUnitTest.h"
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+int main(int argc, char** argv) {
+	std::string filter = argc > 1 ? argv[1] : "";
+	int passed = 0;
+	int failed = 0;
+	for (const TestEntry& test : TestRegistry::tests()) {
+		if (test.name.find(filter) == std::string::npos)
+			continue;
+		try {
+			test.run();
+			++passed;
+		}
+		catch (const AssertFailedException& e) {
+			++failed;
+			std::cout << "FAIL " << test.name << ": " << e.what() << std::endl;
+		}
+		catch (const std::exception& e) {
+			++failed;
+			std::cout << "FAIL " << test.name << ": unexpected exception: " << e.what() << std::endl;
+		}
+	}
+	std::cout << passed << " passed, " << failed << " failed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <fstream>
+#include <string>
+#include <algorithm>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace fefu_laboratory_two {
+	// Размещение памяти по NUMA-узлам: Default — политика процесса (обычно первое касание),
+	// Interleave — страницы по очереди на всех узлах, Local — на узле потока, который первым коснётся страницы,
+	// Node — на узле node
+	enum class NumaPlacement {
+		Default,
+		Interleave,
+		Local,
+		Node
+	};
+
+	struct NumaPolicy {
+		NumaPlacement placement = NumaPlacement::Default;
+		int node = 0;
+	};
+
+	inline bool operator==(const NumaPolicy& lhs, const NumaPolicy& rhs) noexcept {
+		return lhs.placement == rhs.placement && (lhs.placement != NumaPlacement::Node || lhs.node == rhs.node);
+	}
+
+	// Обёртки над mbind/set_mempolicy без зависимости от libnuma. На машине с одним узлом
+	// и вне Linux все вызовы ничего не делают и возвращают false
+	class Numa {
+	public:
+		static constexpr int max_nodes = 1024;
+
+		static int node_count() {
+			static const int count = read_node_count();
+			return count;
+		}
+
+		static std::size_t page_size() {
+#if defined(__linux__)
+			static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+			return size;
+#else
+			return 4096;
+#endif
+		}
+
+		// Задаёт политику для целых страниц внутри [p, p + bytes)
+		static bool bind(void* p, std::size_t bytes, const NumaPolicy& policy) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+			if (policy.placement == NumaPlacement::Default || node_count() <= 1)
+				return false;
+
+			std::uintptr_t page = page_size();
+			std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(p) + page - 1) / page * page;
+			std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(p) + bytes) / page * page;
+			if (begin >= end)
+				return false;
+
+			unsigned long mask[max_nodes / (8 * sizeof(unsigned long))] = {};
+			int mode = fill_mask(policy, mask);
+			return ::syscall(SYS_mbind, begin, end - begin, mode, mask, max_nodes + 1, 0) == 0;
+#else
+			static_cast<void>(p);
+			static_cast<void>(bytes);
+			static_cast<void>(policy);
+			return false;
+#endif
+		}
+
+		// Политика для страниц, которых вызывающий поток коснётся первым
+		static bool set_thread_policy(const NumaPolicy& policy) noexcept {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+			if (node_count() <= 1)
+				return false;
+
+			unsigned long mask[max_nodes / (8 * sizeof(unsigned long))] = {};
+			int mode = policy.placement == NumaPlacement::Default ? mpol_default : fill_mask(policy, mask);
+			return ::syscall(SYS_set_mempolicy, mode, mode == mpol_default ? nullptr : mask, max_nodes + 1) == 0;
+#else
+			static_cast<void>(policy);
+			return false;
+#endif
+		}
+
+	private:
+		// Значения из linux/mempolicy.h
+		static constexpr int mpol_default = 0;
+		static constexpr int mpol_preferred = 1;
+		static constexpr int mpol_interleave = 3;
+
+		static int fill_mask(const NumaPolicy& policy, unsigned long* mask) noexcept {
+			constexpr int bits = 8 * sizeof(unsigned long);
+			switch (policy.placement) {
+			case NumaPlacement::Interleave:
+				for (int node = 0; node < std::min(node_count(), max_nodes); ++node)
+					mask[node / bits] |= 1UL << (node % bits);
+				return mpol_interleave;
+			case NumaPlacement::Node:
+				if (policy.node >= 0 && policy.node < max_nodes)
+					mask[policy.node / bits] |= 1UL << (policy.node % bits);
+				return mpol_preferred;
+			default:
+				// MPOL_PREFERRED с пустой маской — размещение на узле касающегося потока
+				return mpol_preferred;
+			}
+		}
+
+		// /sys/devices/system/node/possible содержит список вида "0" или "0-1"
+		static int read_node_count() {
+			std::ifstream possible("/sys/devices/system/node/possible");
+			std::string nodes;
+			if (!(possible >> nodes))
+				return 1;
+			std::size_t last = nodes.find_last_of(",-");
+			try {
+				return std::stoi(last == std::string::npos ? nodes : nodes.substr(last + 1)) + 1;
+			}
+			catch (...) {
+				return 1;
+			}
+		}
+	};
+
+	// Аллокатор, размещающий буферы чанков по политике. Буферы от страницы и больше выравниваются по странице
+	// и привязываются через mbind; мелкие блоки (заголовки чанков) берутся у operator new без привязки.
+	// Привязка сильнее политики потока (set_thread_policy), поэтому для размещения блока reserve() по частям
+	// на разных узлах есть ChunkList::reserve_parallel(count, placements)
+	template <typename T>
+	class NumaAllocator {
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		NumaPolicy policy;
+
+		constexpr NumaAllocator() noexcept = default;
+
+		constexpr explicit NumaAllocator(const NumaPolicy& policy) noexcept : policy(policy) {};
+
+		template <class U>
+		constexpr NumaAllocator(const NumaAllocator<U>& other) noexcept : policy(other.policy) {};
+
+		T* allocate(size_type N) {
+			std::size_t bytes = N * sizeof(T);
+			if (bytes < Numa::page_size())
+				return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+
+			bytes = (bytes + Numa::page_size() - 1) / Numa::page_size() * Numa::page_size();
+			void* p = ::operator new(bytes, std::align_val_t(Numa::page_size()));
+			Numa::bind(p, bytes, policy);
+			return static_cast<T*>(p);
+		}
+
+		void deallocate(T* p, size_type N) noexcept {
+			if (N * sizeof(T) < Numa::page_size())
+				::operator delete(p, std::align_val_t(alignof(T)));
+			else
+				::operator delete(p, std::align_val_t(Numa::page_size()));
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const NumaAllocator<T>& lhs, const NumaAllocator<U>& rhs) noexcept {
+		return lhs.policy == rhs.policy;
+	}
+}
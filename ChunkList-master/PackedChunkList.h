@@ -0,0 +1,454 @@
+﻿#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "BlockChain.h"
+#include "Chunk.h"
+
+
+namespace fefu_laboratory_two {
+	// Тип значения Bits-битного элемента: однобитные значения — bool, остальные — наименьшее подходящее беззнаковое
+	template <int Bits>
+	using packed_value_t = std::conditional_t<Bits == 1, bool,
+		std::conditional_t<Bits <= 8, std::uint8_t, std::conditional_t<Bits <= 16, std::uint16_t, std::uint32_t>>>;
+
+	// Элементов в чанке PackedChunkList без явного N: чанк занимает 4 КиБ
+	template <int Bits>
+	struct PackedChunkTraits {
+		static constexpr int chunk_size = 4096 * 8 / Bits;
+	};
+
+	// Ссылка на Bits-битное поле внутри слова. Старшие биты присваиваемого значения, не помещающиеся в поле, отбрасываются
+	template <int Bits>
+	class PackedReference {
+	public:
+		using value_type = packed_value_t<Bits>;
+		static constexpr std::uint64_t mask = (std::uint64_t(1) << Bits) - 1;
+
+		PackedReference(std::uint64_t* word, int shift) noexcept : word(word), shift(shift) {}
+
+		PackedReference(const PackedReference& other) noexcept = default;
+
+		operator value_type() const noexcept {
+			return static_cast<value_type>((*word >> shift) & mask);
+		}
+
+		PackedReference& operator=(value_type value) noexcept {
+			*word = (*word & ~(mask << shift)) | ((static_cast<std::uint64_t>(value) & mask) << shift);
+			return *this;
+		}
+
+		PackedReference& operator=(const PackedReference& other) noexcept {
+			return *this = static_cast<value_type>(other);
+		}
+
+		// Инвертирует все биты поля
+		void flip() noexcept {
+			*word ^= mask << shift;
+		}
+
+	private:
+		std::uint64_t* word;
+		int shift;
+	};
+
+	// Чанк PackedChunkList: N Bits-битных элементов в одном Chunk<std::uint64_t>.
+	// Биты за последним элементом чанка всегда нулевые: на этом держатся сдвиги, count и find
+	template <int Bits, int N, typename Allocator>
+	struct PackedBlock {
+		static constexpr int per_word = 64 / Bits;
+		static constexpr int words_per_chunk = N / per_word;
+
+		using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t>;
+
+		Chunk<std::uint64_t, word_allocator> words;
+		PackedBlock* prev = nullptr;
+		PackedBlock* next = nullptr;
+		int size = 0;
+
+		explicit PackedBlock(const Allocator& alloc) : words(words_per_chunk, word_allocator(alloc)) {
+			std::fill_n(words.list, words_per_chunk, 0);
+			words.num_of_elements = words_per_chunk;
+		}
+
+		int count() const noexcept {
+			return size;
+		}
+
+		int used_words() const noexcept {
+			return (size + per_word - 1) / per_word;
+		}
+
+		// Чанк копируется словами, с тем же заполнением, что у other
+		void copy_from(const PackedBlock& other) noexcept {
+			std::memcpy(words.list, other.words.list, other.used_words() * sizeof(std::uint64_t));
+			size = other.size;
+		}
+
+		static std::uint64_t low_bits(int count) noexcept {
+			return count >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+		}
+
+		// Биты элементов [first, last) в слове index
+		static std::uint64_t range_mask(int index, int first, int last) noexcept {
+			int base = index * per_word;
+			return low_bits((std::min(last, base + per_word) - base) * Bits) & ~low_bits((std::max(first, base) - base) * Bits);
+		}
+	};
+
+	// Список Bits-битных значений (Bits — степень двойки меньше 64), упакованных по 64 / Bits в слово.
+	// Чанк — это N элементов в одном Chunk<std::uint64_t>; цепочку чанков ведёт BlockChain, деление полного
+	// чанка при вставке устроено как в ChunkList, а вставка и удаление сдвигают хвост чанка целыми словами.
+	// count, find, fill, append, flip и копирование работают по словам, count — через popcount
+	template <int Bits, int N = PackedChunkTraits<Bits>::chunk_size, typename Allocator = Allocator<std::uint64_t>>
+	class PackedChunkList : public BlockChain<PackedBlock<Bits, N, Allocator>, Allocator> {
+		static_assert(Bits > 0 && Bits < 64 && 64 % Bits == 0, "Bits must be a power of two below 64");
+		static_assert(N > 0 && N * Bits % 128 == 0, "Chunk must hold an even number of whole words");
+
+		using Block = PackedBlock<Bits, N, Allocator>;
+		using base = BlockChain<Block, Allocator>;
+		using base::first_block;
+		using base::tail_block;
+		using base::block_count;
+		using base::list_size;
+		using base::locate;
+		using base::insert_block_after;
+		using base::unlink_block;
+
+		static constexpr int per_word = Block::per_word;
+		static constexpr int words_per_chunk = Block::words_per_chunk;
+		static constexpr std::uint64_t element_mask = PackedReference<Bits>::mask;
+		// Младший бит каждого поля слова
+		static constexpr std::uint64_t low_field_bits = ~std::uint64_t(0) / element_mask;
+
+		template <bool Const>
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = packed_value_t<Bits>;
+			using difference_type = std::ptrdiff_t;
+			using reference = std::conditional_t<Const, value_type, PackedReference<Bits>>;
+
+			Iterator() noexcept = default;
+			Iterator(Block* block, int offset) noexcept : block(block), offset(offset) {}
+
+			reference operator*() const noexcept {
+				return PackedReference<Bits>(block->words.list + offset / per_word, offset % per_word * Bits);
+			}
+
+			Iterator& operator++() noexcept {
+				if (++offset == block->size) {
+					block = block->next;
+					offset = 0;
+				}
+				return *this;
+			}
+
+			Iterator operator++(int) noexcept {
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+				return lhs.block == rhs.block && lhs.offset == rhs.offset;
+			}
+
+		private:
+			Block* block = nullptr;
+			int offset = 0;
+		};
+
+	public:
+		using value_type = packed_value_t<Bits>;
+		using size_type = std::size_t;
+		using allocator_type = Allocator;
+		using reference = PackedReference<Bits>;
+		using const_reference = value_type;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		static constexpr int bits = Bits;
+		static constexpr int chunk_size = N;
+
+		explicit PackedChunkList(const Allocator& alloc = Allocator()) : base(alloc) {}
+
+		PackedChunkList(size_type count, value_type value, const Allocator& alloc = Allocator()) : base(alloc) {
+			append(count, value);
+		}
+
+		PackedChunkList(std::initializer_list<value_type> init, const Allocator& alloc = Allocator()) : base(alloc) {
+			for (value_type value : init)
+				push_back(value);
+		}
+
+		size_type capacity() const noexcept {
+			return block_count * N;
+		}
+
+		reference at(size_type pos) {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+			return (*this)[pos];
+		}
+
+		const_reference at(size_type pos) const {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+			return (*this)[pos];
+		}
+
+		reference operator[](size_type pos) {
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			return element(block, offset);
+		}
+
+		const_reference operator[](size_type pos) const {
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			return element(block, offset);
+		}
+
+		reference front() {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return element(first_block, 0);
+		}
+
+		const_reference front() const {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return element(first_block, 0);
+		}
+
+		reference back() {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return element(tail_block, tail_block->size - 1);
+		}
+
+		const_reference back() const {
+			if (list_size == 0)
+				throw std::logic_error("Empty");
+			return element(tail_block, tail_block->size - 1);
+		}
+
+		iterator begin() noexcept {
+			return iterator(first_block, 0);
+		}
+
+		iterator end() noexcept {
+			return iterator();
+		}
+
+		const_iterator begin() const noexcept {
+			return const_iterator(first_block, 0);
+		}
+
+		const_iterator end() const noexcept {
+			return const_iterator();
+		}
+
+		void push_back(value_type value) {
+			if (tail_block == nullptr || tail_block->size == N)
+				insert_block_after(tail_block);
+			element(tail_block, tail_block->size++) = value;
+			++list_size;
+		}
+
+		void pop_back() {
+			if (list_size == 0)
+				return;
+
+			element(tail_block, --tail_block->size) = value_type();
+			--list_size;
+			if (tail_block->size == 0)
+				unlink_block(tail_block);
+		}
+
+		// Вставляет value перед pos; хвост чанка сдвигается на одно поле целыми словами, полный чанк делится пополам
+		void insert(size_type pos, value_type value) {
+			if (pos > list_size)
+				throw std::out_of_range("Out of range");
+			if (pos == list_size) {
+				push_back(value);
+				return;
+			}
+
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			if (block->size == N) {
+				Block* half = split(block);
+				if (offset >= N / 2) {
+					offset -= N / 2;
+					block = half;
+				}
+			}
+
+			std::uint64_t* words = block->words.list;
+			int first = offset / per_word;
+			for (int i = block->size / per_word; i > first; --i)
+				words[i] = (words[i] << Bits) | (words[i - 1] >> (64 - Bits));
+			std::uint64_t below = Block::low_bits(offset % per_word * Bits);
+			words[first] = (words[first] & below) | ((words[first] & ~below) << Bits);
+			++block->size;
+			++list_size;
+			element(block, offset) = value;
+		}
+
+		void erase(size_type pos) {
+			if (pos >= list_size)
+				throw std::out_of_range("Out of range");
+
+			int offset = 0;
+			Block* block = locate(pos, offset);
+			std::uint64_t* words = block->words.list;
+			int first = offset / per_word;
+			int last = (block->size - 1) / per_word;
+			std::uint64_t below = Block::low_bits(offset % per_word * Bits);
+			words[first] = (words[first] & below) | ((words[first] >> Bits) & ~below);
+			for (int i = first; i < last; ++i) {
+				words[i] |= words[i + 1] << (64 - Bits);
+				words[i + 1] >>= Bits;
+			}
+			--block->size;
+			--list_size;
+			if (block->size == 0)
+				unlink_block(block);
+		}
+
+		// Число элементов, равных value. Поля слова сравниваются с value разом, совпадения считает popcount
+		size_type count(value_type value) const noexcept {
+			std::uint64_t pattern = broadcast(value);
+			size_type result = 0;
+			for (Block* block = first_block; block != nullptr; block = block->next) {
+				int used = block->used_words();
+				for (int i = 0; i < used; ++i)
+					result += std::popcount(matches(block->words.list[i], pattern) & Block::range_mask(i, 0, block->size));
+			}
+			return result;
+		}
+
+		// Позиция первого элемента, равного value, начиная с from; size(), если такого нет
+		size_type find(value_type value, size_type from = 0) const noexcept {
+			if (from >= list_size)
+				return list_size;
+
+			std::uint64_t pattern = broadcast(value);
+			int offset = 0;
+			Block* block = locate(from, offset);
+			size_type base = from - offset;
+			for (; block != nullptr; base += block->size, block = block->next, offset = 0) {
+				int used = block->used_words();
+				for (int i = offset / per_word; i < used; ++i) {
+					std::uint64_t found = matches(block->words.list[i], pattern) & Block::range_mask(i, offset, block->size);
+					if (found != 0)
+						return base + i * per_word + std::countr_zero(found) / Bits;
+				}
+			}
+			return list_size;
+		}
+
+		// Присваивает value всем элементам
+		void fill(value_type value) noexcept {
+			for (Block* block = first_block; block != nullptr; block = block->next)
+				fill_range(block, 0, block->size, value);
+		}
+
+		// Дописывает count копий value в конец
+		void append(size_type count, value_type value) {
+			while (count > 0) {
+				if (tail_block == nullptr || tail_block->size == N)
+					insert_block_after(tail_block);
+				int take = static_cast<int>(std::min<size_type>(count, N - tail_block->size));
+				fill_range(tail_block, tail_block->size, tail_block->size + take, value);
+				tail_block->size += take;
+				list_size += take;
+				count -= take;
+			}
+		}
+
+		void resize(size_type count, value_type value = value_type()) {
+			if (count >= list_size) {
+				append(count - list_size, value);
+				return;
+			}
+			if (count == 0) {
+				this->clear();
+				return;
+			}
+
+			while (list_size - tail_block->size >= count) {
+				list_size -= tail_block->size;
+				unlink_block(tail_block);
+			}
+			int keep = static_cast<int>(count - (list_size - tail_block->size));
+			fill_range(tail_block, keep, tail_block->size, value_type());
+			tail_block->size = keep;
+			list_size = count;
+		}
+
+		// Инвертирует все биты всех элементов
+		void flip() noexcept {
+			for (Block* block = first_block; block != nullptr; block = block->next) {
+				int used = block->used_words();
+				for (int i = 0; i < used; ++i)
+					block->words.list[i] ^= Block::range_mask(i, 0, block->size);
+			}
+		}
+
+	private:
+		// Слово, в каждом поле которого записано value
+		static std::uint64_t broadcast(value_type value) noexcept {
+			return (static_cast<std::uint64_t>(value) & element_mask) * low_field_bits;
+		}
+
+		// Младший бит поля установлен, если поле word равно полю pattern: отличающиеся биты поля сворачиваются в младший
+		static std::uint64_t matches(std::uint64_t word, std::uint64_t pattern) noexcept {
+			std::uint64_t diff = word ^ pattern;
+			for (int shift = 1; shift < Bits; shift *= 2)
+				diff |= diff >> shift;
+			return ~diff & low_field_bits;
+		}
+
+		static reference element(Block* block, int offset) noexcept {
+			return reference(block->words.list + offset / per_word, offset % per_word * Bits);
+		}
+
+		static void fill_range(Block* block, int first, int last, value_type value) noexcept {
+			std::uint64_t pattern = broadcast(value);
+			for (int i = first / per_word; i * per_word < last; ++i) {
+				std::uint64_t mask = Block::range_mask(i, first, last);
+				block->words.list[i] = (block->words.list[i] & ~mask) | (pattern & mask);
+			}
+		}
+
+		// Переносит вторую половину полного чанка в новый; половина чанка — целое число слов
+		Block* split(Block* block) {
+			Block* half = insert_block_after(block);
+			std::uint64_t* upper = block->words.list + words_per_chunk / 2;
+			std::memcpy(half->words.list, upper, words_per_chunk / 2 * sizeof(std::uint64_t));
+			std::fill_n(upper, words_per_chunk / 2, 0);
+			block->size = N / 2;
+			half->size = N / 2;
+			return half;
+		}
+	};
+
+	template <int Bits, int N, typename Allocator>
+	void swap(PackedChunkList<Bits, N, Allocator>& lhs, PackedChunkList<Bits, N, Allocator>& rhs) noexcept {
+		lhs.swap(rhs);
+	}
+}
+
+// Специализация ChunkList<bool> стоит на PackedChunkList и подключается вслед за ним
+#include "BoolChunkList.h"